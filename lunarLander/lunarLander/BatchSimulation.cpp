@@ -0,0 +1,438 @@
+#include <cmath>
+#include <utility>
+#include "BatchSimulation.h"
+#include "JobSystem.h"
+
+// What an episode ran into during the current step
+constexpr uint8_t CONTACT_PC      = 1 << 0,
+                  CONTACT_SHROOM  = 1 << 1,
+                  CONTACT_NO_FUEL = 1 << 2,
+                  CONTACT_PAD     = 1 << 3,
+                  CONTACT_TERRAIN = 1 << 4;
+
+// Separation of the lander's box from a platform's, negative (the shallower axis) when they
+// overlap; SpatialQuery measures it the same way
+float platform_gap(float x, float y, float platform_x, float platform_y, float platform_width, float platform_height) {
+    float gap_x = fabsf(x - platform_x) - (PLAYER_WIDTH + platform_width) / 2.0f,
+          gap_y = fabsf(y - platform_y) - (PLAYER_HEIGHT + platform_height) / 2.0f;
+
+    if (gap_x < 0.0f && gap_y < 0.0f) return fmaxf(gap_x, gap_y);
+    gap_x = fmaxf(gap_x, 0.0f);
+    gap_y = fmaxf(gap_y, 0.0f);
+    return sqrtf(gap_x * gap_x + gap_y * gap_y);
+}
+
+BatchSimulation::BatchSimulation(int episode_count)
+    : m_episode_count(episode_count), m_active_count(episode_count),
+    m_position_x(episode_count), m_position_y(episode_count),
+    m_velocity_x(episode_count), m_velocity_y(episode_count),
+    m_fuel(episode_count), m_outcome(episode_count), m_steps(episode_count),
+    m_acceleration_x(episode_count), m_acceleration_y(episode_count),
+    m_displacement_x(episode_count), m_displacement_y(episode_count),
+    m_substeps(episode_count), m_contacts(episode_count)
+{
+    for (int p = 0; p < PLATFORM_COUNT; p++) {
+        const PlatformLayout& layout = LEVEL_PLATFORMS[p];
+        m_platform_x[p] = layout.m_x;
+        m_platform_y[p] = layout.m_y;
+        m_platform_width[p] = layout.m_width;
+        m_platform_height[p] = layout.m_height;
+        m_platform_contact[p] = layout.m_type == PC ? CONTACT_PC : (layout.m_type == SHROOM ? CONTACT_SHROOM : 0);
+    }
+
+    // ––––– TERRAIN ––––– //
+    // The same ground Terrain::generate builds for the game
+    m_column_width = (TERRAIN_RIGHT - TERRAIN_LEFT) / (float)TERRAIN_COLUMNS;
+    m_inverse_column_width = 1.0f / m_column_width;
+
+    for (int sample = 0; sample <= TERRAIN_COLUMNS; sample++) {
+        float x = TERRAIN_LEFT + (TERRAIN_RIGHT - TERRAIN_LEFT) * (float)sample / (float)TERRAIN_COLUMNS;
+        m_terrain_heights[sample] = terrain_height(x, TERRAIN_BASE, TERRAIN_ROUGHNESS);
+    }
+
+    for (int column = 0; column < TERRAIN_COLUMNS; column++) m_terrain_pad[column] = -1;
+    for (int p = 0; p < PAD_COUNT; p++) {
+        int first = (int)lroundf((LEVEL_PADS[p].m_left - TERRAIN_LEFT) * m_inverse_column_width),
+            last = (int)lroundf((LEVEL_PADS[p].m_right - TERRAIN_LEFT) * m_inverse_column_width);
+        for (int sample = first; sample <= last; sample++) m_terrain_heights[sample] = LEVEL_PADS[p].m_y;
+        for (int column = first; column < last; column++) m_terrain_pad[column] = p;
+    }
+
+    for (int column = 0; column < TERRAIN_COLUMNS; column++) {
+        m_terrain_slopes[column] = (m_terrain_heights[column + 1] - m_terrain_heights[column]) * m_inverse_column_width;
+    }
+
+    reset();
+}
+
+int const BatchSimulation::column_at(float x) const {
+    int column = (int)floorf((x - TERRAIN_LEFT) * m_inverse_column_width);
+    if (column < 0) return 0;
+    if (column >= TERRAIN_COLUMNS) return TERRAIN_COLUMNS - 1;
+    return column;
+}
+
+float const BatchSimulation::height_at(float x) const {
+    int column = column_at(x);
+    return m_terrain_heights[column] + m_terrain_slopes[column] * (x - (TERRAIN_LEFT + column * m_column_width));
+}
+
+void BatchSimulation::reset_episode(int episode, float position_x, float position_y, float velocity_x, float velocity_y, float fuel) {
+    m_position_x[episode] = position_x;
+    m_position_y[episode] = position_y;
+    m_velocity_x[episode] = velocity_x;
+    m_velocity_y[episode] = velocity_y;
+    m_fuel[episode] = fuel;
+    m_outcome[episode] = OUTCOME_RUNNING;
+    m_steps[episode] = 0;
+    if (episode >= m_active_count) m_active_count = episode + 1;
+}
+
+void BatchSimulation::reset() {
+    for (int i = 0; i < m_episode_count; i++) {
+        reset_episode(i, PLAYER_START_X, PLAYER_START_Y, 0.0f, 0.0f, PLAYER_FUEL);
+    }
+}
+
+void BatchSimulation::reset_done() {
+    for (int i = 0; i < m_episode_count; i++) {
+        if (m_outcome[i] != OUTCOME_RUNNING) reset_episode(i, PLAYER_START_X, PLAYER_START_Y, 0.0f, 0.0f, PLAYER_FUEL);
+    }
+}
+
+// Thrust, braking and fuel burn as in Entity::begin_update, the attractors' pull as in GravityField
+// and the substep count as in PhysicsWorld::choose_substeps. Returns the most substeps any
+// episode in the range takes.
+int BatchSimulation::begin_step(int begin, int end, const uint8_t* actions, float delta_time) {
+    const float* position_x = m_position_x.data();
+    const float* position_y = m_position_y.data();
+    const float* velocity_x = m_velocity_x.data();
+    const float* velocity_y = m_velocity_y.data();
+    float* fuel = m_fuel.data();
+    float* acceleration_x = m_acceleration_x.data();
+    float* acceleration_y = m_acceleration_y.data();
+    int* substeps = m_substeps.data();
+    uint8_t* contacts = m_contacts.data();
+    const uint8_t* outcome = m_outcome.data();
+
+    const float speed = PLAYER_SPEED;
+    int most_substeps = 0;
+
+    for (int i = begin; i < end; i++) {
+        uint8_t action = actions[i];
+
+        float movement_x = (action & ACTION_LEFT) ? -1.0f : ((action & ACTION_RIGHT) ? 1.0f : 0.0f);
+        float movement_y = (action & ACTION_UP)   ?  1.0f : ((action & ACTION_DOWN)  ? -1.0f : 0.0f);
+
+        // process_input normalises diagonal movement
+        float length_squared = movement_x * movement_x + movement_y * movement_y;
+        float normaliser = length_squared > 1.0f ? 1.0f / sqrtf(length_squared) : 1.0f;
+        movement_x *= normaliser;
+        movement_y *= normaliser;
+
+        float x = position_x[i],
+              y = position_y[i],
+              vx = velocity_x[i],
+              vy = velocity_y[i];
+
+        float thrust_x = movement_x != 0.0f ? movement_x * speed
+                       : (vx == 0.0f ? 0.0f : (vx < 0.0f ? speed : -speed));
+        float thrust_y = movement_y != 0.0f ? movement_y * speed
+                       : (vy == -0.25f ? -0.25f : (vy < -0.25f ? speed : -speed));
+
+        bool running = outcome[i] == OUTCOME_RUNNING;
+        bool has_fuel = fuel[i] > 0.0f;
+        bool moving = running && has_fuel;
+
+        float burn = (movement_x != 0.0f ? 1.0f : 0.0f) + (movement_y != 0.0f ? 1.0f : 0.0f);
+        fuel[i] = moving ? fuel[i] - burn : fuel[i];
+
+        // ––––– ATTRACTORS ––––– //
+        float pull_x = 0.0f,
+              pull_y = 0.0f;
+        for (int a = 0; a < ATTRACTOR_COUNT; a++) {
+            float offset_x = LEVEL_ATTRACTORS[a].m_x - x,
+                  offset_y = LEVEL_ATTRACTORS[a].m_y - y;
+            float distance_squared = offset_x * offset_x + offset_y * offset_y + SOFTENING * SOFTENING;
+            float strength = LEVEL_ATTRACTORS[a].m_mass / (distance_squared * sqrtf(distance_squared));
+            pull_x += offset_x * strength;
+            pull_y += offset_y * strength;
+        }
+
+        acceleration_x[i] = thrust_x + pull_x * GRAVITATIONAL_CONSTANT;
+        acceleration_y[i] = thrust_y + pull_y * GRAVITATIONAL_CONSTANT;
+
+        // ––––– SUBSTEPS ––––– //
+        float travel = sqrtf(vx * vx + vy * vy) * delta_time;
+        int count = (int)ceilf(travel / (fminf(PLAYER_WIDTH, PLAYER_HEIGHT) * MAX_TRAVEL_FRACTION));
+
+        // Within reach of a platform or the ground this step: slow down to get the contact right
+        float reach = CONTACT_DISTANCE + travel;
+        float half_width = PLAYER_WIDTH / 2.0f;
+        float distance = y - PLAYER_HEIGHT / 2.0f - fmaxf(height_at(x), fmaxf(height_at(x - half_width), height_at(x + half_width)));
+        for (int p = 0; p < PLATFORM_COUNT; p++) {
+            distance = fminf(distance, platform_gap(x, y, m_platform_x[p], m_platform_y[p], m_platform_width[p], m_platform_height[p]));
+        }
+
+        count = count < CONTACT_SUBSTEPS && distance < reach ? CONTACT_SUBSTEPS : count;
+        count = count < 1 ? 1 : (count > MAX_SUBSTEPS ? MAX_SUBSTEPS : count);
+
+        substeps[i] = moving ? count : 0;
+        most_substeps = substeps[i] > most_substeps ? substeps[i] : most_substeps;
+
+        contacts[i] = (running && !has_fuel) ? CONTACT_NO_FUEL : 0;
+    }
+
+    return most_substeps;
+}
+
+// Velocity and displacement for one substep, as in Entity::integrate. Episodes that take fewer
+// substeps than `substep` sit this one out.
+void BatchSimulation::integrate(int begin, int end, int substep, float delta_time) {
+    float* velocity_x = m_velocity_x.data();
+    float* velocity_y = m_velocity_y.data();
+    const float* acceleration_x = m_acceleration_x.data();
+    const float* acceleration_y = m_acceleration_y.data();
+    float* displacement_x = m_displacement_x.data();
+    float* displacement_y = m_displacement_y.data();
+    const int* substeps = m_substeps.data();
+
+    for (int i = begin; i < end; i++) {
+        bool active = substep < substeps[i];
+        float substep_time = delta_time / (float)(active ? substeps[i] : 1);
+
+        float vx = active ? velocity_x[i] + acceleration_x[i] * substep_time : velocity_x[i];
+        float vy = active ? velocity_y[i] + acceleration_y[i] * substep_time : velocity_y[i];
+        velocity_x[i] = vx;
+        velocity_y[i] = vy;
+
+        displacement_x[i] = active ? vx * substep_time : 0.0f;
+        displacement_y[i] = active ? vy * substep_time : 0.0f;
+    }
+}
+
+// Entity::sweep_and_slide for every episode at once
+void BatchSimulation::sweep(int begin, int end) {
+    float* position_x = m_position_x.data();
+    float* position_y = m_position_y.data();
+    float* velocity_x = m_velocity_x.data();
+    float* velocity_y = m_velocity_y.data();
+    float* displacement_x = m_displacement_x.data();
+    float* displacement_y = m_displacement_y.data();
+    uint8_t* contacts = m_contacts.data();
+
+    // Only episodes that hit something have a remainder to slide, and most steps nobody does
+    bool sliding = true;
+    for (int iteration = 0; iteration < MAX_SWEEP_ITERATIONS && sliding; iteration++) {
+        sliding = false;
+
+        for (int i = begin; i < end; i++) {
+            float dx = displacement_x[i],
+                  dy = displacement_y[i];
+            if (dx == 0.0f && dy == 0.0f) continue;     // done, sitting out this substep, or finished
+
+            float time_of_impact = 1.0f;
+            float normal_x = 0.0f,
+                  normal_y = 0.0f;
+            uint8_t contact = 0;
+
+            for (int p = 0; p < PLATFORM_COUNT; p++) {
+                float relative_x = position_x[i] - m_platform_x[p];
+                float relative_y = position_y[i] - m_platform_y[p];
+                float half_width  = (PLAYER_WIDTH  + m_platform_width[p])  / 2.0f;
+                float half_height = (PLAYER_HEIGHT + m_platform_height[p]) / 2.0f;
+
+                // A still axis either always overlaps (-inf, inf) or never does (inf, -inf)
+                bool outside_x = fabsf(relative_x) >= half_width;
+                bool outside_y = fabsf(relative_y) >= half_height;
+                // Divide rather than multiply by a reciprocal so the rounding matches Entity::sweep
+                float divisor_x = dx != 0.0f ? dx : 1.0f;
+                float divisor_y = dy != 0.0f ? dy : 1.0f;
+
+                float x_entry = dx != 0.0f ? ((dx > 0.0f ? -half_width : half_width) - relative_x) / divisor_x
+                                           : (outside_x ? INFINITY : -INFINITY);
+                float x_exit  = dx != 0.0f ? ((dx > 0.0f ? half_width : -half_width) - relative_x) / divisor_x
+                                           : (outside_x ? -INFINITY : INFINITY);
+                float y_entry = dy != 0.0f ? ((dy > 0.0f ? -half_height : half_height) - relative_y) / divisor_y
+                                           : (outside_y ? INFINITY : -INFINITY);
+                float y_exit  = dy != 0.0f ? ((dy > 0.0f ? half_height : -half_height) - relative_y) / divisor_y
+                                           : (outside_y ? -INFINITY : INFINITY);
+
+                float entry = fmaxf(x_entry, y_entry);
+                float exit  = fminf(x_exit, y_exit);
+                bool overlap = entry < exit && entry < 0.0f && exit > 0.0f;
+                bool hit = entry < exit && entry >= 0.0f && entry <= 1.0f && entry < time_of_impact;
+
+                // Already inside: out along the axis of least penetration, dropping velocity and
+                // displacement that head back in
+                float x_penetration = half_width - fabsf(relative_x);
+                float y_penetration = half_height - fabsf(relative_y);
+                bool along_y = y_penetration <= x_penetration;
+                float out_x = relative_x >= 0.0f ? 1.0f : -1.0f;
+                float out_y = relative_y >= 0.0f ? 1.0f : -1.0f;
+                float vx = velocity_x[i];
+                float vy = velocity_y[i];
+
+                position_y[i] += overlap && along_y ? out_y * y_penetration : 0.0f;
+                velocity_y[i] = overlap && along_y && vy * out_y < 0.0f ? 0.0f : vy;
+                dy = overlap && along_y && dy * out_y < 0.0f ? 0.0f : dy;
+                position_x[i] += overlap && !along_y ? out_x * x_penetration : 0.0f;
+                velocity_x[i] = overlap && !along_y && vx * out_x < 0.0f ? 0.0f : vx;
+                dx = overlap && !along_y && dx * out_x < 0.0f ? 0.0f : dx;
+                contacts[i] |= overlap ? m_platform_contact[p] : 0;
+
+                bool x_axis = x_entry > y_entry;
+                time_of_impact = hit ? entry : time_of_impact;
+                normal_x = hit ? (x_axis ? (dx > 0.0f ? -1.0f : 1.0f) : 0.0f) : normal_x;
+                normal_y = hit ? (x_axis ? 0.0f : (dy > 0.0f ? -1.0f : 1.0f)) : normal_y;
+                contact  = hit ? m_platform_contact[p] : contact;
+            }
+
+            bool hit = time_of_impact < 1.0f;
+
+            position_x[i] += dx * time_of_impact;
+            position_y[i] += dy * time_of_impact;
+
+            contacts[i] |= hit ? contact : 0;
+            velocity_x[i] = (hit && normal_x != 0.0f) ? 0.0f : velocity_x[i];
+            velocity_y[i] = (hit && normal_y != 0.0f) ? 0.0f : velocity_y[i];
+
+            // Slide the rest of the step along the contact; without a contact the step is done
+            float remaining = 1.0f - time_of_impact;
+            dx *= remaining;
+            dy *= remaining;
+            float along_normal = dx * normal_x + dy * normal_y;
+            displacement_x[i] = hit ? dx - normal_x * along_normal : 0.0f;
+            displacement_y[i] = hit ? dy - normal_y * along_normal : 0.0f;
+            sliding |= hit;
+        }
+    }
+}
+
+// Terrain::collide: out of the highest ground under the footprint. Only a footprint entirely on
+// one pad lands; anything else is a crash.
+void BatchSimulation::collide_terrain(int begin, int end, int substep) {
+    const float* position_x = m_position_x.data();
+    float* position_y = m_position_y.data();
+    float* velocity_y = m_velocity_y.data();
+    uint8_t* contacts = m_contacts.data();
+    const int* substeps = m_substeps.data();
+
+    for (int i = begin; i < end; i++) {
+        float left = fmaxf(position_x[i] - PLAYER_WIDTH / 2.0f, TERRAIN_LEFT),
+              right = fminf(position_x[i] + PLAYER_WIDTH / 2.0f, TERRAIN_RIGHT);
+        if (substep >= substeps[i] || left > right) continue;
+
+        int first = column_at(left),
+            last = column_at(right);
+        if (last > first && TERRAIN_LEFT + last * m_column_width >= right) last--;
+
+        float ground = fmaxf(height_at(left), height_at(right));
+        for (int sample = first + 1; sample <= last; sample++) ground = fmaxf(ground, m_terrain_heights[sample]);
+
+        float depth = ground - (position_y[i] - PLAYER_HEIGHT / 2.0f);
+        if (depth <= 0.0f) continue;
+
+        position_y[i] += depth;
+        velocity_y[i] = fmaxf(velocity_y[i], 0.0f);
+
+        bool on_pad = m_terrain_pad[first] >= 0 && m_terrain_pad[first] == m_terrain_pad[last];
+        contacts[i] |= on_pad ? CONTACT_PAD : CONTACT_TERRAIN;
+    }
+}
+
+// The gameplay phase: contacts become outcomes, rewards and observations
+void BatchSimulation::finish(int begin, int end, float* observations, float* rewards, uint8_t* dones) {
+    for (int i = begin; i < end; i++) {
+        uint8_t contacts = m_contacts[i];
+        bool running = m_outcome[i] == OUTCOME_RUNNING;
+
+        // The game shows the win screen when a step touches a pc or pad and a shroom or the ground at once
+        uint8_t outcome = (contacts & CONTACT_NO_FUEL)                   ? OUTCOME_OUT_OF_FUEL
+                        : (contacts & (CONTACT_PC | CONTACT_PAD))         ? OUTCOME_WON
+                        : (contacts & (CONTACT_SHROOM | CONTACT_TERRAIN)) ? OUTCOME_LOST
+                        : OUTCOME_RUNNING;
+
+        float reward = outcome == OUTCOME_WON ? WIN_REWARD
+                     : outcome == OUTCOME_LOST ? LOSE_REWARD
+                     : outcome == OUTCOME_OUT_OF_FUEL ? OUT_OF_FUEL_REWARD
+                     : 0.0f;
+
+        m_outcome[i] = running ? outcome : m_outcome[i];
+        m_steps[i] += running ? 1 : 0;
+
+        rewards[i] = running ? reward : 0.0f;
+        dones[i] = m_outcome[i] != OUTCOME_RUNNING;
+
+        float* observation = observations + i * OBSERVATION_SIZE;
+        observation[0] = m_position_x[i];
+        observation[1] = m_position_y[i];
+        observation[2] = m_velocity_x[i];
+        observation[3] = m_velocity_y[i];
+        observation[4] = m_fuel[i];
+    }
+}
+
+void BatchSimulation::step_range(int begin, int end, const uint8_t* actions, float* observations, float* rewards, uint8_t* dones, float delta_time) {
+    int substeps = begin_step(begin, end, actions, delta_time);
+
+    for (int substep = 0; substep < substeps; substep++) {
+        integrate(begin, end, substep, delta_time);
+        sweep(begin, end);
+        collide_terrain(begin, end, substep);
+    }
+
+    finish(begin, end, observations, rewards, dones);
+}
+
+void BatchSimulation::step(const uint8_t* actions, float* observations, float* rewards, uint8_t* dones, float delta_time) {
+    if (m_job_system == nullptr || m_active_count <= PARALLEL_CHUNK) {
+        step_range(0, m_active_count, actions, observations, rewards, dones, delta_time);
+        return;
+    }
+
+    m_job_system->parallel_for(m_active_count, PARALLEL_CHUNK, [=, this](int begin, int end) {
+        step_range(begin, end, actions, observations, rewards, dones, delta_time);
+    });
+}
+
+void BatchSimulation::observe(float* observations) const {
+    for (int i = 0; i < m_episode_count; i++) {
+        float* observation = observations + i * OBSERVATION_SIZE;
+        observation[0] = m_position_x[i];
+        observation[1] = m_position_y[i];
+        observation[2] = m_velocity_x[i];
+        observation[3] = m_velocity_y[i];
+        observation[4] = m_fuel[i];
+    }
+}
+
+void BatchSimulation::swap_episodes(int episode, int other_episode) {
+    std::swap(m_position_x[episode], m_position_x[other_episode]);
+    std::swap(m_position_y[episode], m_position_y[other_episode]);
+    std::swap(m_velocity_x[episode], m_velocity_x[other_episode]);
+    std::swap(m_velocity_y[episode], m_velocity_y[other_episode]);
+    std::swap(m_fuel[episode], m_fuel[other_episode]);
+    std::swap(m_outcome[episode], m_outcome[other_episode]);
+    std::swap(m_steps[episode], m_steps[other_episode]);
+}
+
+// Running episodes from the back trade places with finished ones from the front
+int BatchSimulation::compact(int* ids) {
+    int front = 0,
+        back = m_active_count - 1;
+
+    while (true) {
+        while (front <= back && m_outcome[front] == OUTCOME_RUNNING) front++;
+        while (front < back && m_outcome[back] != OUTCOME_RUNNING) back--;
+        if (front >= back) break;
+
+        swap_episodes(front, back);
+        std::swap(ids[front], ids[back]);
+        front++;
+        back--;
+    }
+
+    m_active_count = front;
+    return m_active_count;
+}
@@ -0,0 +1,119 @@
+#ifndef BATCHSIMULATION_H
+#define BATCHSIMULATION_H
+
+#include <cstdint>
+#include <vector>
+#include "Level.h"
+
+class JobSystem;
+
+// Action bits for one episode, same meaning as the arrow keys
+enum BatchAction : uint8_t {
+    ACTION_NONE  = 0,
+    ACTION_LEFT  = 1 << 0,
+    ACTION_RIGHT = 1 << 1,
+    ACTION_UP    = 1 << 2,
+    ACTION_DOWN  = 1 << 3
+};
+
+enum BatchOutcome : uint8_t { OUTCOME_RUNNING, OUTCOME_WON, OUTCOME_LOST, OUTCOME_OUT_OF_FUEL };
+
+// Steps many independent lander episodes in lockstep without SDL or OpenGL.
+// Episode state is stored as one array per field so every stage of the step is a flat pass over
+// contiguous arrays; episodes with nothing to do in a stage are skipped. The physics mirrors
+// PhysicsWorld::step for the level in Level.h: thrust and fuel burn, the attractors' pull,
+// adaptive substeps, and in every substep the swept collision against the platforms (pushing out
+// of any the lander starts inside) followed by the terrain.
+// Two things are simplified: the platforms are only their hand-tuned boxes (the game's pixel
+// masks can only narrow those), and since touching the ground ends an episode, a terrain
+// contact pushes the lander up but does not slide it along the slope.
+//
+// Buffers passed to step() belong to the caller:
+//   actions       episode_count bytes of BatchAction bits
+//   observations  episode_count * OBSERVATION_SIZE floats (x, y, velocity x, velocity y, fuel)
+//   rewards       episode_count floats
+//   dones         episode_count bytes, 1 once the episode has an outcome
+// Finished episodes stay frozen until they are reset. compact() moves them behind the running
+// ones and step() then leaves them out, which pays off when episodes end at very different times.
+class BatchSimulation {
+private:
+    int m_episode_count;
+    int m_active_count;                     // step() covers episodes [0, m_active_count)
+
+    // ————— EPISODE STATE ————— //
+    std::vector<float> m_position_x, m_position_y;
+    std::vector<float> m_velocity_x, m_velocity_y;
+    std::vector<float> m_fuel;
+    std::vector<uint8_t> m_outcome;
+    std::vector<int> m_steps;
+
+    // ————— PER-STEP SCRATCH ————— //
+    std::vector<float> m_acceleration_x, m_acceleration_y;     // thrust and braking plus the attractors' pull
+    std::vector<float> m_displacement_x, m_displacement_y;
+    std::vector<int> m_substeps;                                 // 0 for episodes that do not move this step
+    std::vector<uint8_t> m_contacts;
+
+    // ————— LEVEL ————— //
+    float m_platform_x[PLATFORM_COUNT], m_platform_y[PLATFORM_COUNT];
+    float m_platform_width[PLATFORM_COUNT], m_platform_height[PLATFORM_COUNT];
+    uint8_t m_platform_contact[PLATFORM_COUNT];
+
+    float m_terrain_heights[TERRAIN_COLUMNS + 1];
+    float m_terrain_slopes[TERRAIN_COLUMNS];
+    int m_terrain_pad[TERRAIN_COLUMNS];          // -1 off the pads
+    float m_column_width, m_inverse_column_width;
+
+    JobSystem* m_job_system = nullptr;
+
+    int const column_at(float x) const;
+    float const height_at(float x) const;
+
+    int begin_step(int begin, int end, const uint8_t* actions, float delta_time);
+    void integrate(int begin, int end, int substep, float delta_time);
+    void sweep(int begin, int end);
+    void collide_terrain(int begin, int end, int substep);
+    void finish(int begin, int end, float* observations, float* rewards, uint8_t* dones);
+    void step_range(int begin, int end, const uint8_t* actions, float* observations, float* rewards, uint8_t* dones, float delta_time);
+    void swap_episodes(int episode, int other_episode);
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int OBSERVATION_SIZE = 5;
+    static constexpr int PARALLEL_CHUNK = 4096;    // episodes per job when a job system is attached
+    static constexpr int MAX_SWEEP_ITERATIONS = 3;  // same as Entity::MAX_SWEEP_ITERATIONS
+    static constexpr int MAX_SUBSTEPS = 8;          // these four are PhysicsWorld's
+    static constexpr int CONTACT_SUBSTEPS = 2;
+    static constexpr float MAX_TRAVEL_FRACTION = 0.25f;
+    static constexpr float CONTACT_DISTANCE = 0.1f;
+    static constexpr float SOFTENING = 0.1f;        // same as GravityField::DEFAULT_SOFTENING
+
+    static constexpr float WIN_REWARD = 1.0f,
+                           LOSE_REWARD = -1.0f,
+                           OUT_OF_FUEL_REWARD = -1.0f;
+
+    // ————— METHODS ————— //
+    explicit BatchSimulation(int episode_count);
+
+    void set_job_system(JobSystem* job_system) { m_job_system = job_system; }
+
+    void reset();                   // every episode back to the level's start
+    void reset_done();              // only the episodes that have finished
+    void reset_episode(int episode, float position_x, float position_y, float velocity_x, float velocity_y, float fuel);
+
+    void step(const uint8_t* actions, float* observations, float* rewards, uint8_t* dones, float delta_time = FIXED_TIMESTEP);
+    void observe(float* observations) const;
+
+    // Moves the running episodes to the front and steps only those from now on; `ids` (one per
+    // episode) is permuted along with them so the caller can follow where each one went. Returns
+    // how many are still running. reset(), reset_done() and reset_episode() widen the range again.
+    int compact(int* ids);
+
+    // ————— GETTERS ————— //
+    int const get_episode_count() const { return m_episode_count; }
+    int const get_active_count() const { return m_active_count; }
+    BatchOutcome const get_outcome(int episode) const { return (BatchOutcome)m_outcome[episode]; }
+    int const get_steps(int episode) const { return m_steps[episode]; }
+    float const get_fuel(int episode) const { return m_fuel[episode]; }
+};
+
+#endif // BATCHSIMULATION_H
@@ -0,0 +1,77 @@
+#include <cmath>
+#include "CollisionMask.h"
+
+void CollisionMask::build(const unsigned char* rgba, int width, int height, unsigned char alpha_threshold) {
+    m_width = width;
+    m_height = height;
+    m_words_per_row = (width + 63) / 64;
+    m_bits.assign((size_t)m_words_per_row * height, 0);
+
+    for (int y = 0; y < height; y++) {
+        const unsigned char* pixel = rgba + (size_t)y * width * 4;
+        for (int x = 0; x < width; x++) {
+            if (pixel[x * 4 + 3] >= alpha_threshold) set(x, y);
+        }
+    }
+}
+
+CollisionMask CollisionMask::resample(int source_x, int source_y, int source_width, int source_height, int width, int height) const {
+    CollisionMask mask;
+    mask.m_width = width;
+    mask.m_height = height;
+    mask.m_words_per_row = (width + 63) / 64;
+    mask.m_bits.assign((size_t)mask.m_words_per_row * height, 0);
+
+    for (int y = 0; y < height; y++) {
+        int sample_y = source_y + (int)(((float)y + 0.5f) * source_height / height);
+        for (int x = 0; x < width; x++) {
+            int sample_x = source_x + (int)(((float)x + 0.5f) * source_width / width);
+            if (get(sample_x, sample_y)) mask.set(x, y);
+        }
+    }
+
+    return mask;
+}
+
+CollisionMask CollisionMask::resample_to_world(int source_x, int source_y, int source_width, int source_height, float world_width, float world_height) const {
+    int width = (int)lroundf(world_width * TEXELS_PER_UNIT),
+        height = (int)lroundf(world_height * TEXELS_PER_UNIT);
+    return resample(source_x, source_y, source_width, source_height, width < 1 ? 1 : width, height < 1 ? 1 : height);
+}
+
+// 64 pixels of `row` starting at `first_bit`, stitched from the two words it straddles.
+// Pixels past the end of the row read as zero.
+uint64_t const CollisionMask::window(int row, int first_bit) const {
+    const uint64_t* words = &m_bits[(size_t)row * m_words_per_row];
+    int word = first_bit >> 6,
+        shift = first_bit & 63;
+
+    uint64_t bits = words[word] >> shift;
+    if (shift != 0 && word + 1 < m_words_per_row) bits |= words[word + 1] << (64 - shift);
+    return bits;
+}
+
+bool const CollisionMask::overlaps(const CollisionMask& other, int offset_x, int offset_y) const {
+    // Overlap of the two rectangles, in our pixels
+    int left = offset_x > 0 ? offset_x : 0,
+        top = offset_y > 0 ? offset_y : 0,
+        right = offset_x + other.m_width < m_width ? offset_x + other.m_width : m_width,
+        bottom = offset_y + other.m_height < m_height ? offset_y + other.m_height : m_height;
+
+    if (left >= right || top >= bottom) { return false; }
+
+    for (int y = top; y < bottom; y++) {
+        int other_y = y - offset_y;
+
+        for (int x = left; x < right; x += 64) {
+            uint64_t bits = window(y, x) & other.window(other_y, x - offset_x);
+
+            int remaining = right - x;
+            if (remaining < 64) bits &= (uint64_t(1) << remaining) - 1;
+
+            if (bits != 0) return true;
+        }
+    }
+
+    return false;
+}
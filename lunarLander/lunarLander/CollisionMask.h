@@ -0,0 +1,49 @@
+#ifndef COLLISIONMASK_H
+#define COLLISIONMASK_H
+
+#include <cstdint>
+#include <vector>
+
+// One bit per pixel, set where the sprite is opaque enough to be hit. Rows are packed into
+// 64-bit words (pixel x is bit x % 64 of word x / 64) and run top to bottom like the image.
+//
+// Two masks are compared 64 pixels at a time: each row of the overlap is read out of both masks
+// as a window starting at any bit, shifted into line and ANDed. Masks built straight from a
+// texture are in texels; resample() them to TEXELS_PER_UNIT of world space first so two sprites
+// drawn at different sizes share a grid and only differ by a whole-pixel offset.
+class CollisionMask {
+private:
+    int m_width = 0,
+        m_height = 0,
+        m_words_per_row = 0;
+    std::vector<uint64_t> m_bits;
+
+    uint64_t const window(int row, int first_bit) const;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr unsigned char DEFAULT_ALPHA_THRESHOLD = 128;
+    static constexpr float TEXELS_PER_UNIT = 64.0f;
+
+    // ————— METHODS ————— //
+    void build(const unsigned char* rgba, int width, int height, unsigned char alpha_threshold = DEFAULT_ALPHA_THRESHOLD);
+
+    // Nearest-neighbour copy of the source rectangle (e.g. one frame of a sprite sheet)
+    CollisionMask resample(int source_x, int source_y, int source_width, int source_height, int width, int height) const;
+    CollisionMask resample_to_world(int source_x, int source_y, int source_width, int source_height, float world_width, float world_height) const;
+
+    // Whether any pixel is set in both masks when `other`'s top-left pixel sits at
+    // (offset_x, offset_y) in ours
+    bool const overlaps(const CollisionMask& other, int offset_x, int offset_y) const;
+
+    // ————— GETTERS ————— //
+    bool const get(int x, int y) const { return (m_bits[y * m_words_per_row + (x >> 6)] >> (x & 63)) & 1; }
+    int const get_width() const { return m_width; }
+    int const get_height() const { return m_height; }
+    bool const is_empty() const { return m_width == 0 || m_height == 0; }
+
+    // ————— SETTERS ————— //
+    void set(int x, int y) { m_bits[y * m_words_per_row + (x >> 6)] |= uint64_t(1) << (x & 63); }
+};
+
+#endif // COLLISIONMASK_H
@@ -0,0 +1,66 @@
+#ifndef CONTACTEVENT_H
+#define CONTACTEVENT_H
+
+#include <vector>
+#include "glm/glm.hpp"
+#include "Entity.h"
+
+enum ContactEventType { CONTACT, OUT_OF_FUEL };
+
+// One thing that happened to an entity during a step. Collision code only records these;
+// deciding what they mean for the game (win, lose, ...) happens after the step.
+struct ContactEvent {
+    ContactEventType m_type;
+    Entity* m_entity;               // the body that moved
+    Entity* m_other;                // what it touched, nullptr for OUT_OF_FUEL and terrain
+    EntityType m_other_type;
+    glm::vec3 m_normal;             // points from m_other towards m_entity
+    float m_depth;                  // 0 for swept contacts, penetration for overlaps
+};
+
+// Per-step list of events. Give each worker its own buffer and append() them together
+// afterwards to keep detection free of shared state.
+class ContactBuffer {
+private:
+    std::vector<ContactEvent> m_events;
+    int m_pairs_tested = 0;         // narrowphase tests that produced these events, hit or miss
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int DEFAULT_CAPACITY = 64;
+
+    // ————— METHODS ————— //
+    ContactBuffer() { m_events.reserve(DEFAULT_CAPACITY); }
+
+    void add_contact(Entity* entity, Entity* other, glm::vec3 normal, float depth) {
+        m_events.push_back(ContactEvent { CONTACT, entity, other, other->get_entity_type(), normal, depth });
+    }
+
+    // Static geometry that is not an entity (terrain) reports only what kind of thing was hit
+    void add_contact(Entity* entity, EntityType other_type, glm::vec3 normal, float depth) {
+        m_events.push_back(ContactEvent { CONTACT, entity, nullptr, other_type, normal, depth });
+    }
+
+    void add_out_of_fuel(Entity* entity) {
+        m_events.push_back(ContactEvent { OUT_OF_FUEL, entity, nullptr, entity->get_entity_type(), glm::vec3(0.0f), 0.0f });
+    }
+
+    void add_pairs_tested(int count) { m_pairs_tested += count; }
+
+    void append(const ContactBuffer& other) {
+        m_events.insert(m_events.end(), other.m_events.begin(), other.m_events.end());
+        m_pairs_tested += other.m_pairs_tested;
+    }
+    void clear() { m_events.clear(); m_pairs_tested = 0; }
+
+    // ————— GETTERS ————— //
+    int const get_count() const { return (int)m_events.size(); }
+    bool const is_empty() const { return m_events.empty(); }
+    int const get_pairs_tested() const { return m_pairs_tested; }
+    const ContactEvent& operator[](int index) const { return m_events[index]; }
+
+    std::vector<ContactEvent>::const_iterator begin() const { return m_events.begin(); }
+    std::vector<ContactEvent>::const_iterator end() const { return m_events.end(); }
+};
+
+#endif // CONTACTEVENT_H
@@ -22,69 +22,101 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
 #include "Entity.h"
+#include "ContactEvent.h"
+#include "Profiler.h"
+#include "Logger.h"
 
-// Default constructor
+// Default constructor: a static sprite with no physics or animation
 Entity::Entity()
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(0.0f), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(0), m_velocity(0.0f), m_acceleration(0.0f), m_width(0.0f), m_height(0.0f)
+    : m_position(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
+    m_texture_id(0), m_width(0.0f), m_height(0.0f), m_arena(LevelArena::current())
 {
-    // Initialize m_walking with zeros or any default value
-    for (int i = 0; i < SECONDS_PER_FRAME; ++i)
-        for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
 }
 
 // Parameterized constructor
 Entity::Entity(GLuint texture_id, float speed, glm::vec3 acceleration, float jump_power, int walking[4][4], float animation_time,
     int animation_frames, int animation_index, int animation_cols,
     int animation_rows, float width, float height)
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed),m_acceleration(acceleration), m_jumping_power(jump_power), m_animation_cols(animation_cols),
-    m_animation_frames(animation_frames), m_animation_index(animation_index),
-    m_animation_rows(animation_rows), m_animation_indices(nullptr),
-    m_animation_time(animation_time), m_texture_id(texture_id), m_velocity(0.0f),
-    m_width(width), m_height(height)
+    : m_position(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
+    m_texture_id(texture_id), m_width(width), m_height(height), m_arena(LevelArena::current())
 {
+    add_physics();
+    m_physics->m_speed = speed;
+    m_physics->m_acceleration = acceleration;
+    m_physics->m_jumping_power = jump_power;
+    
+    add_animation();
+    m_animation->m_animation_cols = animation_cols;
+    m_animation->m_animation_frames = animation_frames;
+    m_animation->m_animation_index = animation_index;
+    m_animation->m_animation_rows = animation_rows;
+    m_animation->m_animation_time = animation_time;
+    
     face_right();
     set_walking(walking);
 }
 
 // Simpler constructor for partial initialization
 Entity::Entity(GLuint texture_id, float speed,  float width, float height)
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(texture_id), m_velocity(0.0f), m_acceleration(0.0f), m_width(width), m_height(height)
+    : m_position(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
+    m_texture_id(texture_id), m_width(width), m_height(height), m_arena(LevelArena::current())
 {
-    // Initialize m_walking with zeros or any default value
-    for (int i = 0; i < SECONDS_PER_FRAME; ++i)
-        for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
+    add_physics();
+    m_physics->m_speed = speed;
 }
 
-Entity::~Entity() { }
+Entity::~Entity() {
+    // Arena-backed components are released with the rest of the level
+    if (m_arena != nullptr) { return; }
+    
+    delete m_physics;
+    delete m_animation;
+}
 
-void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index) {
+void Entity::add_physics() {
+    if (m_physics != nullptr) { return; }
+    
+    if (m_arena != nullptr) m_physics = new (m_arena->allocate(sizeof(PhysicsComponent), alignof(PhysicsComponent))) PhysicsComponent();
+    else                    m_physics = new PhysicsComponent();
+}
+
+void Entity::add_animation() {
+    if (m_animation != nullptr) { return; }
+    
+    if (m_arena != nullptr) m_animation = new (m_arena->allocate(sizeof(AnimationComponent), alignof(AnimationComponent))) AnimationComponent();
+    else                    m_animation = new AnimationComponent();
+}
+
+void Entity::atlas_tex_coords(int index, float tex_coords[12]) const {
     // Step 1: Calculate the UV location of the indexed frame
-    float u_coord = (float)(index % m_animation_cols) / (float)m_animation_cols;
-    float v_coord = (float)(index / m_animation_cols) / (float)m_animation_rows;
+    int animation_cols = m_animation->m_animation_cols,
+        animation_rows = m_animation->m_animation_rows;
+    
+    float u_coord = (float)(index % animation_cols) / (float)animation_cols;
+    float v_coord = (float)(index / animation_cols) / (float)animation_rows;
 
     // Step 2: Calculate its UV size
-    float width = 1.0f / (float)m_animation_cols;
-    float height = 1.0f / (float)m_animation_rows;
+    float width = 1.0f / (float)animation_cols;
+    float height = 1.0f / (float)animation_rows;
 
     // Step 3: Just as we have done before, match the texture coordinates to the vertices
-    float tex_coords[] = {
+    float coords[] = {
         u_coord, v_coord + height, u_coord + width, v_coord + height, u_coord + width, v_coord,
         u_coord, v_coord + height, u_coord + width, v_coord, u_coord, v_coord
     };
+    for (int i = 0; i < 12; i++) tex_coords[i] = coords[i];
+}
+
+void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index) {
+    float tex_coords[12];
+    atlas_tex_coords(index, tex_coords);
 
     float vertices[] = {
         -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
         -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
     };
 
-    // Step 4: And render
+    // And render
     glBindTexture(GL_TEXTURE_2D, texture_id);
 
     glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
@@ -94,6 +126,7 @@ void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint textu
     glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    program->count_draw_call();
 
     glDisableVertexAttribArray(program->get_position_attribute());
     glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
@@ -104,145 +137,337 @@ bool const Entity::check_collision(Entity* other) const {
     float x_distance = fabs(m_position.x - other->m_position.x) - ((m_width + other->m_width) / 2.0f);
     float y_distance = fabs(m_position.y - other->m_position.y) - ((m_height + other->m_height) / 2.0f);
 
-    return x_distance < 0.0f && y_distance < 0.0f;
+    if (x_distance >= 0.0f || y_distance >= 0.0f) { return false; }
+    
+    // The hand-tuned boxes are only the broad phase; with masks on both sides ask the pixels
+    if (is_precise() && other->is_precise()) { return check_mask_collision(other); }
+    
+    return true;
 }
 
-void const Entity::check_collision_y(Entity *collidable_entities, int collidable_entity_count, bool& g_win, bool& g_lose) {
-    for (int i = 0; i < collidable_entity_count; i++) {
-        Entity *collidable_entity = &collidable_entities[i];
+const CollisionMask& Entity::current_mask() const {
+    if (m_collision_mask_count > 1 && m_animation != nullptr && m_animation->m_animation_indices != nullptr) {
+        int frame = m_animation->m_animation_indices[m_animation->m_animation_index];
+        if (frame >= 0 && frame < m_collision_mask_count) return m_collision_masks[frame];
+    }
+    return m_collision_masks[0];
+}
+
+// Entities that do not animate count as facing right, like a fresh animated one
+AnimationDirection const Entity::get_facing() const {
+    if (m_animation != nullptr) {
+        for (int direction = LEFT; direction <= DOWN; direction++) {
+            if (m_animation->m_animation_indices == m_animation->m_walking[direction]) return (AnimationDirection)direction;
+        }
+    }
+    return RIGHT;
+}
+
+bool const Entity::check_mask_collision(const Entity* other, glm::vec3 position) const {
+    const CollisionMask& mask = current_mask();
+    const CollisionMask& other_mask = other->current_mask();
+    
+    // Where the other mask's top-left pixel lands in ours; mask rows run downwards, world y runs up
+    float texels = CollisionMask::TEXELS_PER_UNIT;
+    int offset_x = (int)lroundf((other->m_position.x - position.x) * texels + (mask.get_width() - other_mask.get_width()) / 2.0f);
+    int offset_y = (int)lroundf((position.y - other->m_position.y) * texels + (mask.get_height() - other_mask.get_height()) / 2.0f);
+    
+    return mask.overlaps(other_mask, offset_x, offset_y);
+}
+
+// Swept AABB test against a single collider. Returns the fraction of `displacement` that can be
+// travelled before touching `other` (1.0f if it is never touched) and writes the contact normal.
+// Boxes that already overlap at the start return 0.0f with the minimum translation vector instead:
+// `normal` along the axis they penetrate least and `penetration` how deep. For precise pairs the
+// box sweep is only the broad phase; see sweep_masks().
+float const Entity::sweep(const Entity* other, glm::vec3 displacement, glm::vec3& normal, float& penetration) const {
+    if (!m_is_active || !other->m_is_active) { return 1.0f; }
+    
+    // Shrink ourselves to a point and grow the other box by our half extents (Minkowski sum)
+    glm::vec3 relative = m_position - other->m_position;
+    float half_width  = (m_width  + other->m_width)  / 2.0f;
+    float half_height = (m_height + other->m_height) / 2.0f;
+    
+    float x_entry, x_exit, y_entry, y_exit;
+    
+    if (displacement.x == 0.0f) {
+        if (fabs(relative.x) >= half_width) { return 1.0f; }
+        x_entry = -INFINITY;
+        x_exit  =  INFINITY;
+    } else {
+        float near_x = displacement.x > 0.0f ? -half_width :  half_width;
+        float far_x  = displacement.x > 0.0f ?  half_width : -half_width;
+        x_entry = (near_x - relative.x) / displacement.x;
+        x_exit  = (far_x  - relative.x) / displacement.x;
+    }
+    
+    if (displacement.y == 0.0f) {
+        if (fabs(relative.y) >= half_height) { return 1.0f; }
+        y_entry = -INFINITY;
+        y_exit  =  INFINITY;
+    } else {
+        float near_y = displacement.y > 0.0f ? -half_height :  half_height;
+        float far_y  = displacement.y > 0.0f ?  half_height : -half_height;
+        y_entry = (near_y - relative.y) / displacement.y;
+        y_exit  = (far_y  - relative.y) / displacement.y;
+    }
+    
+    float entry = fmax(x_entry, y_entry);
+    float exit  = fmin(x_exit, y_exit);
+    
+    bool precise = is_precise() && other->is_precise();
+    
+    if (entry >= exit || entry > 1.0f || exit <= 0.0f) { return 1.0f; }
+    
+    // Precise pairs only overlap once the masks touch, but the push-out still uses the boxes: a
+    // deliberate approximation, since it is tiny once a sweep has stopped at the mask contact
+    if (entry < 0.0f && (!precise || check_mask_collision(other))) {
+        float x_penetration = half_width - fabs(relative.x);
+        float y_penetration = half_height - fabs(relative.y);
         
-        if (check_collision(collidable_entity)) {
-            if (collidable_entity->get_entity_type() == SHROOM) {
-                g_lose = true;
-            } else if (collidable_entity->get_entity_type() == PC) {
-                g_win = true;
-            }
-            
-            float y_distance = fabs(m_position.y - collidable_entity->m_position.y);
-            float y_overlap = fabs(y_distance - (m_height / 2.0f) - (collidable_entity->m_height / 2.0f));
-            if (m_velocity.y > 0) {
-                m_position.y -= y_overlap;
-                m_velocity.y = 0;
-                m_collided_top = true;          // Collision!
-            } else if (m_velocity.y < 0) {
-                m_position.y += y_overlap;
-                m_velocity.y = 0;
-                m_collided_bottom = true;       // Collision!
-            }
+        if (y_penetration <= x_penetration) {
+            normal = glm::vec3(0.0f, relative.y >= 0.0f ? 1.0f : -1.0f, 0.0f);
+            penetration = y_penetration;
+        } else {
+            normal = glm::vec3(relative.x >= 0.0f ? 1.0f : -1.0f, 0.0f, 0.0f);
+            penetration = x_penetration;
         }
+        return 0.0f;
+    }
+    
+    // The axis we crossed last is the one we hit
+    if (x_entry > y_entry) {
+        normal = glm::vec3(displacement.x > 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f);
+    } else {
+        normal = glm::vec3(0.0f, displacement.y > 0.0f ? -1.0f : 1.0f, 0.0f);
+    }
+    
+    if (precise) { return sweep_masks(other, displacement, fmax(entry, 0.0f), fmin(exit, 1.0f)); }
+    
+    return entry;
+}
+
+// Narrow phase for precise pairs: walks the stretch of the path where the boxes overlap one texel at
+// a time and stops at the last position before the masks touch. sweep() has already dealt with
+// masks that touch at the start.
+float const Entity::sweep_masks(const Entity* other, glm::vec3 displacement, float entry, float exit) const {
+    float travel = fmax(fabs(displacement.x), fabs(displacement.y)) * CollisionMask::TEXELS_PER_UNIT;
+    float step = travel > 1.0f ? 1.0f / travel : 1.0f;
+    
+    // t from an integer count of steps, so rounding does not build up over a long walk
+    float clear = entry;
+    for (int k = 0; clear < exit; k++) {
+        float time = fmin(entry + k * step, exit);
+        if (check_mask_collision(other, m_position + displacement * time)) { return clear; }
+        clear = time;
     }
+    
+    return 1.0f;
 }
 
-void const Entity::check_collision_x(Entity *collidable_entities, int collidable_entity_count, bool& g_win, bool& g_lose) {
-    for (int i = 0; i < collidable_entity_count; i++) {
-        Entity *collidable_entity = &collidable_entities[i];
+// Moves by `displacement`, stopping at the earliest time of impact against the collidables and
+// sliding the rest of the step along the contact surface. Because every candidate is tested over
+// the whole path, fast bodies can no longer skip over thin platforms between two steps. This is the
+// only narrowphase pass: a collider the body is already inside (spawned there, or rounding at an
+// earlier contact) is pushed out of as soon as the pass finds it.
+void Entity::sweep_and_slide(glm::vec3 displacement, Entity* collidable_entities, int collidable_entity_count, ContactBuffer& contacts) {
+    if (m_physics == nullptr) { return; }
+    PROFILE_SCOPE("Entity::sweep_and_slide");
+    
+    for (int iteration = 0; iteration < MAX_SWEEP_ITERATIONS; iteration++) {
+        if (displacement.x == 0.0f && displacement.y == 0.0f) { return; }
         
-        if (check_collision(collidable_entity)) {
-            if (collidable_entity->get_entity_type() == SHROOM) {
-                g_lose = true;
-            } else if (collidable_entity->get_entity_type() == PC) {
-                g_win = true;
-            }
+        float time_of_impact = 1.0f;
+        glm::vec3 contact_normal(0.0f);
+        Entity* contact_entity = nullptr;
+        
+        contacts.add_pairs_tested(collidable_entity_count);
+        for (int i = 0; i < collidable_entity_count; i++) {
+            glm::vec3 normal(0.0f);
+            float penetration = 0.0f;
+            float toi = sweep(&collidable_entities[i], displacement, normal, penetration);
             
-            float x_distance = fabs(m_position.x - collidable_entity->m_position.x);
-            float x_overlap = fabs(x_distance - (m_width / 2.0f) - (collidable_entity->m_width / 2.0f));
-            if (m_velocity.x > 0) {
-                m_position.x  -= x_overlap;
-                m_velocity.x = 0;
-                m_collided_right = true;        // Collision!
+            if (penetration > 0.0f) {
+                push_out(&collidable_entities[i], normal, penetration, contacts);
                 
-            } else if (m_velocity.x < 0) {
-                m_position.x += x_overlap;
-                m_velocity.x = 0;
-                m_collided_left = true;         // Collision!
+                // Keep only the part of the step that does not head back in
+                float into = glm::dot(displacement, normal);
+                if (into < 0.0f) displacement -= normal * into;
+                continue;
+            }
+            
+            if (toi < time_of_impact) {
+                time_of_impact = toi;
+                contact_normal = normal;
+                contact_entity = &collidable_entities[i];
             }
         }
+        
+        m_position += displacement * time_of_impact;
+        
+        if (contact_entity == nullptr) { return; }
+        
+        contacts.add_contact(this, contact_entity, contact_normal, 0.0f);
+        
+        if (contact_normal.y != 0.0f) {
+            m_physics->m_velocity.y = 0;
+            if (contact_normal.y > 0.0f) m_physics->m_collided_bottom = true;
+            else                         m_physics->m_collided_top    = true;
+        } else {
+            m_physics->m_velocity.x = 0;
+            if (contact_normal.x > 0.0f) m_physics->m_collided_left  = true;
+            else                         m_physics->m_collided_right = true;
+        }
+        
+        // Whatever is left of the step slides along the surface we hit
+        displacement *= 1.0f - time_of_impact;
+        displacement -= contact_normal * glm::dot(displacement, contact_normal);
     }
 }
 
-void Entity::update(float delta_time, Entity* collidable_entities, int collidable_entity_count, bool& g_win, bool& g_lose, bool& g_nofuel) {
+// Out of an overlap along the minimum translation vector; only velocity heading back into the
+// collider is removed
+void Entity::push_out(Entity* collidable_entity, glm::vec3 normal, float penetration, ContactBuffer& contacts) {
+    PhysicsComponent& physics = *m_physics;
     
-    if (!m_is_active) { return; }
+    if (normal.y != 0.0f) {
+        m_position.y += normal.y * penetration;
+        if (physics.m_velocity.y * normal.y < 0.0f) physics.m_velocity.y = 0;
+        
+        if (normal.y > 0.0f) physics.m_collided_bottom = true;      // Collision!
+        else                 physics.m_collided_top    = true;
+    } else {
+        m_position.x += normal.x * penetration;
+        if (physics.m_velocity.x * normal.x < 0.0f) physics.m_velocity.x = 0;
+        
+        if (normal.x > 0.0f) physics.m_collided_left  = true;       // Collision!
+        else                 physics.m_collided_right = true;
+    }
+    
+    contacts.add_contact(this, collidable_entity, normal, penetration);
+}
+
+void Entity::update(float delta_time, Entity* collidable_entities, int collidable_entity_count, ContactBuffer& contacts) {
+    PROFILE_SCOPE("Entity::update");
+    if (!begin_update(delta_time, contacts)) { return; }
+    
+    integrate(delta_time, collidable_entities, collidable_entity_count, contacts);
+    end_update();
+}
+
+// Once per step: input, fuel and the resulting acceleration. Returns whether there is anything
+// to integrate; integrate() may then run several times over smaller slices of the step.
+bool Entity::begin_update(float delta_time, ContactBuffer& contacts) {
+    if (!m_is_active) { return false; }
+    
+    // Static sprites only need their transform refreshed
+    if (m_physics == nullptr) {
+        update_model_matrix();
+        return false;
+    }
     
-    m_collided_top = false;
-    m_collided_bottom = false;
-    m_collided_left = false;
-    m_collided_right = false;
+    PhysicsComponent& physics = *m_physics;
+    
+    // Sleeping bodies are neither integrated nor collided until something wakes them
+    if (physics.m_is_sleeping) { return false; }
+    
+    physics.m_collided_top = false;
+    physics.m_collided_bottom = false;
+    physics.m_collided_left = false;
+    physics.m_collided_right = false;
     
 //    for (int i = 0; i < collidable_entity_count; i++) {
 //        if (check_collision(&collidable_entities[i])) return;
 //    }
 
-    if (m_animation_indices != NULL) {
-        if (glm::length(m_movement) != 0) {
-            m_animation_time += delta_time;
+    if (m_animation != nullptr && m_animation->m_animation_indices != NULL) {
+        AnimationComponent& animation = *m_animation;
+        
+        if (glm::length(physics.m_movement) != 0) {
+            animation.m_animation_time += delta_time;
             float frames_per_second = 1.0f / SECONDS_PER_FRAME;
 
-            if (m_animation_time >= frames_per_second) {
-                m_animation_time = 0.0f;
-                m_animation_index++;
+            if (animation.m_animation_time >= frames_per_second) {
+                animation.m_animation_time = 0.0f;
+                animation.m_animation_index++;
 
-                if (m_animation_index >= m_animation_frames) {
-                    m_animation_index = 0;
+                if (animation.m_animation_index >= animation.m_animation_frames) {
+                    animation.m_animation_index = 0;
                 }
             }
         }
     }
     
-    if (m_fuel <= 0) {
-        g_nofuel = true;
-        m_acceleration.x = 0.0f;
-        m_acceleration.y = 0.0f;
-        return;
+    if (physics.m_fuel <= 0) {
+        contacts.add_out_of_fuel(this);
+        physics.m_acceleration.x = 0.0f;
+        physics.m_acceleration.y = 0.0f;
+        physics.m_force = glm::vec3(0.0f);
+        return false;
     }
 
-    if (m_movement.x == 0.0f) {
-        if (m_velocity.x == 0.0f) {
-            m_acceleration.x = 0.0f;
+    if (physics.m_movement.x == 0.0f) {
+        if (physics.m_velocity.x == 0.0f) {
+            physics.m_acceleration.x = 0.0f;
         } else {
-            if (m_velocity.x < 0.0f) {
-                m_acceleration.x = 1.0f * m_speed;
+            if (physics.m_velocity.x < 0.0f) {
+                physics.m_acceleration.x = 1.0f * physics.m_speed;
             } else {
-                m_acceleration.x = -1.0f * m_speed;
+                physics.m_acceleration.x = -1.0f * physics.m_speed;
             }
         }
     } else {
-        m_acceleration.x = m_movement.x * m_speed;
-        m_fuel -= 1.0f;
+        physics.m_acceleration.x = physics.m_movement.x * physics.m_speed;
+        physics.m_fuel -= 1.0f;
     }
     
-    if (m_movement.y == 0.0f) {
-        if (m_velocity.y == -0.25f) {
-            m_acceleration.y = -0.25f;
+    if (physics.m_movement.y == 0.0f) {
+        if (physics.m_velocity.y == -0.25f) {
+            physics.m_acceleration.y = -0.25f;
         } else {
-            if (m_velocity.y < -0.25f) {
-                m_acceleration.y = 1.0f * m_speed;
+            if (physics.m_velocity.y < -0.25f) {
+                physics.m_acceleration.y = 1.0f * physics.m_speed;
             } else {
-                m_acceleration.y = -1.0f * m_speed;
+                physics.m_acceleration.y = -1.0f * physics.m_speed;
             }
         }
     } else {
-        m_acceleration.y = m_movement.y * m_speed;
-        m_fuel -= 1.0f;
+        physics.m_acceleration.y = physics.m_movement.y * physics.m_speed;
+        physics.m_fuel -= 1.0f;
     }
     
-    m_movement = glm::vec3(0.0f, 0.0f, 0.0f);
+    physics.m_movement = glm::vec3(0.0f, 0.0f, 0.0f);
     
-    // And we add the gravity next
-    m_velocity += m_acceleration * delta_time;
+    return true;
+}
+
+void Entity::integrate(float delta_time, Entity* collidable_entities, int collidable_entity_count, ContactBuffer& contacts) {
+    PhysicsComponent& physics = *m_physics;
     
-    m_position.y += m_velocity.y * delta_time;
-    check_collision_y(collidable_entities, collidable_entity_count, g_win, g_lose);
+    // And we add the gravity next, plus anything pushed on us since the last step
+    physics.m_velocity += (physics.m_acceleration + physics.m_force) * delta_time;
     
-    m_position.x += m_velocity.x * delta_time;
-    check_collision_x(collidable_entities, collidable_entity_count, g_win, g_lose);
+    sweep_and_slide(physics.m_velocity * delta_time, collidable_entities, collidable_entity_count, contacts);
+}
+
+void Entity::end_update() {
+    PhysicsComponent& physics = *m_physics;
+    physics.m_force = glm::vec3(0.0f);
   
-//    if(m_is_jumping) {
-//        m_is_jumping = false;
-//        m_velocity.y += m_jumping_power;
+//    if(physics.m_is_jumping) {
+//        physics.m_is_jumping = false;
+//        physics.m_velocity.y += physics.m_jumping_power;
 //    }
     
-    std::cout << "Current fuel level: " << m_fuel << std::endl;
+    // Count towards sleeping; the physics world puts the body to sleep once it has been still long enough
+    if (glm::length(physics.m_velocity) < SLEEP_VELOCITY) physics.m_rest_steps++;
+    else physics.m_rest_steps = 0;
+    
+    LOG_EVERY(SEVERITY_DEBUG, FUEL_LOG_INTERVAL, "Current fuel level: %g", physics.m_fuel);
+    update_model_matrix();
+}
+
+void Entity::update_model_matrix() {
     m_model_matrix = glm::mat4(1.0f);
     m_model_matrix = glm::translate(m_model_matrix, m_position);
 //    m_model_matrix = glm::scale(m_model_matrix, m_scale);
@@ -253,8 +478,8 @@ void Entity::render(ShaderProgram* program) {
     
     program->set_model_matrix(m_model_matrix);
 
-    if (m_animation_indices != NULL) {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index]);
+    if (m_animation != nullptr && m_animation->m_animation_indices != NULL) {
+        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation->m_animation_indices[m_animation->m_animation_index]);
         return;
     }
 
@@ -269,6 +494,7 @@ void Entity::render(ShaderProgram* program) {
     glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
 
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    program->count_draw_call();
 
     glDisableVertexAttribArray(program->get_position_attribute());
     glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
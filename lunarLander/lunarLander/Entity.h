@@ -2,29 +2,41 @@
 #define ENTITY_H
 
 #include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "LevelArena.h"
+#include "EntityType.h"
+#include "CollisionMask.h"
 
-enum AnimationDirection { LEFT, RIGHT, UP, DOWN };
-enum EntityType { WIN, LOSE, SHROOM, PC, PLAYER, NOFUEL };
+class ContactBuffer;
 
-class Entity {
-private:
-    bool m_is_active = true;
+// ————— COMPONENTS ————— //
+// Only entities that move or animate carry these; platforms, overlays and the background
+// are just a transform and a texture and never pay for the rest.
+struct PhysicsComponent {
+    glm::vec3 m_movement     = glm::vec3(0.0f);
+    glm::vec3 m_velocity     = glm::vec3(0.0f);
+    glm::vec3 m_acceleration = glm::vec3(0.0f);
+
+    float m_speed = 0.0f;
+    float m_fuel  = 75.0f;
 
-    // ————— TRANSFORMATIONS ————— //
-    glm::vec3 m_movement;
-    glm::vec3 m_scale;
-    
     float m_jumping_power = 0;
     bool m_is_jumping = false;
-    
-    // ————— PHYSICS ————— //
-    glm::vec3 m_position;
-    glm::vec3 m_velocity;
-    glm::vec3 m_acceleration;
 
-    // ————— ANIMATION ————— //
-    int m_walking[4][4];            // 4x4 array for walking animations
+    glm::vec3 m_force = glm::vec3(0.0f);   // accumulated until the next step, unit mass
+
+    bool m_is_sleeping = false;
+    int m_rest_steps = 0;                   // consecutive steps spent below the sleep threshold
+
+    bool m_collided_top    = false;
+    bool m_collided_bottom = false;
+    bool m_collided_left   = false;
+    bool m_collided_right  = false;
+};
+
+struct AnimationComponent {
+    int m_walking[4][4] = {};       // 4x4 array for walking animations
     int m_animation_cols = 0;
     int m_animation_frames = 0,
         m_animation_index = 0,
@@ -32,25 +44,44 @@ private:
 
     int* m_animation_indices = nullptr;
     float m_animation_time = 0.0f;
+};
+
+class Entity {
+private:
+    bool m_is_active = true;
+
+    // ————— TRANSFORMATIONS ————— //
+    glm::vec3 m_position;
+    glm::vec3 m_scale;
 
     float m_width = 1.0f,
           m_height = 1.0f;
-    
-    // ————— COLLISIONS ————— //
-    bool m_collided_top    = false;
-    bool m_collided_bottom = false;
-    bool m_collided_left   = false;
-    bool m_collided_right  = false;
+
+    // ————— OPTIONAL COMPONENTS ————— //
+    PhysicsComponent* m_physics = nullptr;
+    AnimationComponent* m_animation = nullptr;
+    LevelArena* m_arena = nullptr;      // where the components came from; nullptr means the heap
+
+    // ————— PRECISE COLLISION ————— //
+    // World-space masks, one per sprite sheet frame (or just one); owned by whoever loaded the textures
+    const CollisionMask* m_collision_masks = nullptr;
+    int m_collision_mask_count = 0;
+
+    const CollisionMask& current_mask() const;
+
+    PhysicsComponent& physics() { if (m_physics == nullptr) add_physics(); return *m_physics; }
+    AnimationComponent& animation() { if (m_animation == nullptr) add_animation(); return *m_animation; }
 
 public:
     // ————— STATIC VARIABLES ————— //
     static constexpr int SECONDS_PER_FRAME = 4;
+    static constexpr int MAX_SWEEP_ITERATIONS = 3;  // contacts resolved per step before giving up the remainder
+    static constexpr float SLEEP_VELOCITY = 0.05f;  // below this speed a step counts towards sleeping
+    static constexpr float FUEL_LOG_INTERVAL = 1.0f; // seconds between fuel level messages
     
     GLuint m_texture_id;
     glm::mat4 m_model_matrix;
     EntityType m_entity_type;
-    float m_speed;
-    float m_fuel = 75.0f;
 
     // ————— METHODS ————— //
     Entity();
@@ -59,71 +90,109 @@ public:
     Entity(GLuint texture_id, float speed, float width, float height); // Simpler constructor
     ~Entity();
 
+    Entity(const Entity&) = delete;
+    Entity& operator=(const Entity&) = delete;
+
+    void add_physics();
+    void add_animation();
+
+    void atlas_tex_coords(int index, float tex_coords[12]) const;     // UVs of one sprite sheet frame, two triangles
     void draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index);
     bool const check_collision(Entity* other) const;
+    bool const check_mask_collision(const Entity* other) const { return check_mask_collision(other, m_position); }
+    bool const check_mask_collision(const Entity* other, glm::vec3 position) const;     // as if we stood at `position`
+    float const sweep(const Entity* other, glm::vec3 displacement, glm::vec3& normal, float& penetration) const;
+    float const sweep_masks(const Entity* other, glm::vec3 displacement, float entry, float exit) const;
+    void sweep_and_slide(glm::vec3 displacement, Entity* collidable_entities, int collidable_entity_count, ContactBuffer& contacts);
+    void push_out(Entity* collidable_entity, glm::vec3 normal, float penetration, ContactBuffer& contacts);
     
-    void const check_collision_y(Entity* collidable_entities, int collidable_entity_count, bool& g_win, bool& g_lose);
-    void const check_collision_x(Entity* collidable_entities, int collidable_entity_count, bool& g_win, bool& g_lose);
-    void update(float delta_time, Entity* collidable_entities, int collidable_entity_count, bool& g_win, bool& g_lose, bool& g_nofuel);
+    void update(float delta_time, Entity* collidable_entities, int collidable_entity_count, ContactBuffer& contacts);
+    bool begin_update(float delta_time, ContactBuffer& contacts);
+    void integrate(float delta_time, Entity* collidable_entities, int collidable_entity_count, ContactBuffer& contacts);
+    void end_update();
+    void update_model_matrix();
     void render(ShaderProgram* program);
 
-    void normalise_movement() { m_movement = glm::normalize(m_movement); }
+    void normalise_movement() { physics().m_movement = glm::normalize(physics().m_movement); }
+
+    void face_left() { if (m_animation) m_animation->m_animation_indices = m_animation->m_walking[LEFT]; }
+    void face_right() { if (m_animation) m_animation->m_animation_indices = m_animation->m_walking[RIGHT]; }
+    void face_up() { if (m_animation) m_animation->m_animation_indices = m_animation->m_walking[UP]; }
+    void face_down() { if (m_animation) m_animation->m_animation_indices = m_animation->m_walking[DOWN]; }
+    void face(AnimationDirection direction) { if (m_animation) m_animation->m_animation_indices = m_animation->m_walking[direction]; }
 
-    void face_left() { m_animation_indices = m_walking[LEFT]; }
-    void face_right() { m_animation_indices = m_walking[RIGHT]; }
-    void face_up() { m_animation_indices = m_walking[UP]; }
-    void face_down() { m_animation_indices = m_walking[DOWN]; }
+    void move_left() { physics().m_movement.x = -1.0f; wake_up(); face_left(); }
+    void move_right() { physics().m_movement.x = 1.0f;  wake_up(); face_right(); }
+    void move_up() { physics().m_movement.y = 1.0f;  wake_up(); face_up(); }
+    void move_down() { physics().m_movement.y = -1.0f; wake_up(); face_down(); }
 
-    void move_left() { m_movement.x = -1.0f; face_left(); }
-    void move_right() { m_movement.x = 1.0f;  face_right(); }
-    void move_up() { m_movement.y = 1.0f;  face_up(); }
-    void move_down() { m_movement.y = -1.0f; face_down(); }
+    void apply_force(glm::vec3 force) { physics().m_force += force; wake_up(); }
+    void wake_up() { if (m_physics) { m_physics->m_is_sleeping = false; m_physics->m_rest_steps = 0; } }
+    void put_to_sleep() { if (m_physics) { m_physics->m_is_sleeping = true; m_physics->m_velocity = glm::vec3(0.0f); } }
     
-    void const jump() { m_is_jumping = true; }
+    void const jump() { physics().m_is_jumping = true; }
     
     void activate() { m_is_active = true; }
     void deactivate() { m_is_active = false; }
 
     // ————— GETTERS ————— //
+    // Entities without a physics component read as a body at rest with a full tank
     glm::vec3 const get_position() const { return m_position; }
-    glm::vec3 const get_velocity() const { return m_velocity; }
-    glm::vec3 const get_acceleration() const { return m_acceleration; }
-    glm::vec3 const get_movement() const { return m_movement; }
+    glm::vec3 const get_velocity() const { return m_physics ? m_physics->m_velocity : glm::vec3(0.0f); }
+    glm::vec3 const get_acceleration() const { return m_physics ? m_physics->m_acceleration : glm::vec3(0.0f); }
+    glm::vec3 const get_movement() const { return m_physics ? m_physics->m_movement : glm::vec3(0.0f); }
+    AnimationDirection const get_facing() const;
     glm::vec3 const get_scale() const { return m_scale; }
     GLuint const get_texture_id() const { return m_texture_id; }
-    float const get_speed() const { return m_speed; }
-    bool const get_collided_top() const { return m_collided_top; }
-    bool const get_collided_bottom() const { return m_collided_bottom; }
-    bool const get_collided_right() const { return m_collided_right; }
-    bool const get_collided_left() const { return m_collided_left; }
+    float const get_speed() const { return m_physics ? m_physics->m_speed : 0.0f; }
+    bool const get_collided_top() const { return m_physics && m_physics->m_collided_top; }
+    bool const get_collided_bottom() const { return m_physics && m_physics->m_collided_bottom; }
+    bool const get_collided_right() const { return m_physics && m_physics->m_collided_right; }
+    bool const get_collided_left() const { return m_physics && m_physics->m_collided_left; }
     EntityType const get_entity_type() const { return m_entity_type; }
-    float const get_fuel() const { return m_fuel; }
+    float const get_fuel() const { return m_physics ? m_physics->m_fuel : PhysicsComponent().m_fuel; }
+    float const get_width() const { return m_width; }
+    float const get_height() const { return m_height; }
+    bool const is_active() const { return m_is_active; }
+    bool const is_static() const { return m_physics == nullptr; }
+    bool const is_sleeping() const { return m_physics && m_physics->m_is_sleeping; }
+    bool const is_precise() const { return m_collision_masks != nullptr; }
+    PhysicsComponent* const get_physics() const { return m_physics; }
+    AnimationComponent* const get_animation() const { return m_animation; }
     
     // ————— SETTERS ————— //
+    // Setting a physics or animation field adds that component on first use
     void const set_position(glm::vec3 new_position) { m_position = new_position; }
-    void const set_velocity(glm::vec3 new_velocity) { m_velocity = new_velocity; }
-    void const set_acceleration(glm::vec3 new_acceleration) { m_acceleration = new_acceleration; }
-    void const set_movement(glm::vec3 new_movement) { m_movement = new_movement; }
+    void const set_velocity(glm::vec3 new_velocity) { physics().m_velocity = new_velocity; wake_up(); }
+    void const set_acceleration(glm::vec3 new_acceleration) { physics().m_acceleration = new_acceleration; }
+    void const set_movement(glm::vec3 new_movement) { physics().m_movement = new_movement; if (new_movement != glm::vec3(0.0f)) wake_up(); }
     void const set_scale(glm::vec3 new_scale) { m_scale = new_scale; }
     void const set_texture_id(GLuint new_texture_id) { m_texture_id = new_texture_id; }
-    void const set_speed(float new_speed) { m_speed = new_speed; }
-    void const set_animation_cols(int new_cols) { m_animation_cols = new_cols; }
-    void const set_animation_rows(int new_rows) { m_animation_rows = new_rows; }
-    void const set_animation_frames(int new_frames) { m_animation_frames = new_frames; }
-    void const set_animation_index(int new_index) { m_animation_index = new_index; }
-    void const set_animation_time(float new_time) { m_animation_time = new_time; }
-    void const set_jumping_power(float new_jumping_power) { m_jumping_power = new_jumping_power; }
+    void const set_speed(float new_speed) { physics().m_speed = new_speed; }
+    void const set_animation_cols(int new_cols) { animation().m_animation_cols = new_cols; }
+    void const set_animation_rows(int new_rows) { animation().m_animation_rows = new_rows; }
+    void const set_animation_frames(int new_frames) { animation().m_animation_frames = new_frames; }
+    void const set_animation_index(int new_index) { animation().m_animation_index = new_index; }
+    void const set_animation_time(float new_time) { animation().m_animation_time = new_time; }
+    void const set_jumping_power(float new_jumping_power) { physics().m_jumping_power = new_jumping_power; }
     void const set_width(float new_width) { m_width = new_width; }
     void const set_height(float new_height) { m_height = new_height; }
     void const set_size(glm::vec3 size) { m_model_matrix = glm::scale(m_model_matrix, size); }
     void const set_entity_type(EntityType new_entity_type) { m_entity_type = new_entity_type; }
-    void const set_fuel(float new_fuel) { m_fuel = new_fuel; }
+    void const set_fuel(float new_fuel) { physics().m_fuel = new_fuel; }
+    
+    // Switches to pixel-accurate collision: the hand-tuned box stays the broad phase and hits inside
+    // it are decided by the masks. Both entities of a pair need masks for the precise test.
+    void const set_collision_masks(const CollisionMask* masks, int mask_count) {
+        m_collision_masks = masks;
+        m_collision_mask_count = mask_count;
+    }
 
     // Setter for m_walking
     void set_walking(int walking[4][4]) {
         for (int i = 0; i < 4; ++i) {
             for (int j = 0; j < 4; ++j) {
-                m_walking[i][j] = walking[i][j];
+                animation().m_walking[i][j] = walking[i][j];
             }
         }
     }
@@ -0,0 +1,8 @@
+#ifndef ENTITYTYPE_H
+#define ENTITYTYPE_H
+
+// Kept apart from Entity.h so code without SDL/GL (headless simulation, tools) can use them
+enum AnimationDirection { LEFT, RIGHT, UP, DOWN };
+enum EntityType { WIN, LOSE, SHROOM, PC, PLAYER, NOFUEL, TERRAIN, LANDING_PAD };
+
+#endif // ENTITYTYPE_H
@@ -0,0 +1,49 @@
+#include <SDL.h>
+#include "FrameClock.h"
+
+void FrameClock::start(int step_rate, int max_catch_up_steps) {
+    m_frequency = SDL_GetPerformanceFrequency();
+    m_step_rate = (uint64_t)step_rate;
+    m_max_catch_up_steps = max_catch_up_steps;
+
+    m_elapsed_nanoseconds = m_step_count = m_dropped_steps = m_capped_frames = 0;
+    reset();
+}
+
+void FrameClock::reset() {
+    m_previous_counter = SDL_GetPerformanceCounter();
+    m_counter_remainder = 0;
+    m_accumulator = 0;
+}
+
+int FrameClock::advance() {
+    uint64_t counter = SDL_GetPerformanceCounter();
+    uint64_t ticks = counter - m_previous_counter;
+    m_previous_counter = counter;
+
+    // Whole seconds first so ticks * 1e9 cannot overflow after a long stall
+    uint64_t seconds = ticks / m_frequency,
+             rest = ticks % m_frequency * NANOSECONDS_IN_SECOND + m_counter_remainder;
+    m_counter_remainder = rest % m_frequency;
+
+    return advance_by(seconds * NANOSECONDS_IN_SECOND + rest / m_frequency);
+}
+
+int FrameClock::advance_by(uint64_t nanoseconds) {
+    m_elapsed_nanoseconds += nanoseconds;
+    m_accumulator += nanoseconds * m_step_rate;
+
+    uint64_t steps = m_accumulator / NANOSECONDS_IN_SECOND;
+
+    if (steps > (uint64_t)m_max_catch_up_steps) {
+        // Keep the fraction of a step so the next frame still lines up
+        m_dropped_steps += steps - m_max_catch_up_steps;
+        m_capped_frames++;
+        steps = m_max_catch_up_steps;
+    }
+
+    m_accumulator %= NANOSECONDS_IN_SECOND;
+    m_step_count += steps;
+
+    return (int)steps;
+}
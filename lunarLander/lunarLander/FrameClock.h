@@ -0,0 +1,62 @@
+#ifndef FRAMECLOCK_H
+#define FRAMECLOCK_H
+
+#include <cstdint>
+
+// Turns wall-clock time into a whole number of fixed simulation steps per frame.
+//
+// Time is read from the high-resolution performance counter and kept as integers all the way:
+// counter ticks convert to nanoseconds with the remainder carried to the next frame, and the
+// step accumulator counts in nanoseconds * step rate, so a 1/60 s step is exactly one second's
+// worth of units and nothing is lost or counted twice however the frames fall.
+//
+// After a stall (a breakpoint, a dragged window) at most `max_catch_up_steps` run in one frame;
+// whole steps beyond that are dropped and counted instead of spiralling into ever longer frames.
+class FrameClock {
+private:
+    uint64_t m_frequency = 0;               // counter ticks per second
+    uint64_t m_previous_counter = 0;
+    uint64_t m_counter_remainder = 0;       // ticks * 1e9 left over from the last conversion
+
+    uint64_t m_step_rate = DEFAULT_STEP_RATE;
+    uint64_t m_accumulator = 0;             // nanoseconds * m_step_rate; a step costs NANOSECONDS_IN_SECOND
+    int m_max_catch_up_steps = DEFAULT_MAX_CATCH_UP_STEPS;
+
+    uint64_t m_elapsed_nanoseconds = 0;
+    uint64_t m_step_count = 0;
+    uint64_t m_dropped_steps = 0;
+    uint64_t m_capped_frames = 0;           // frames that hit the catch-up cap
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr uint64_t NANOSECONDS_IN_SECOND = 1000000000;
+    static constexpr int DEFAULT_STEP_RATE = 60;
+    static constexpr int DEFAULT_MAX_CATCH_UP_STEPS = 8;    // ~133 ms of simulation per frame at 60 Hz
+
+    // ————— METHODS ————— //
+    void start(int step_rate = DEFAULT_STEP_RATE, int max_catch_up_steps = DEFAULT_MAX_CATCH_UP_STEPS);
+
+    // Reads the counter and returns how many fixed steps are due this frame
+    int advance();
+    // Same, for `nanoseconds` of elapsed time that did not come from the counter (replays, tests)
+    int advance_by(uint64_t nanoseconds);
+
+    // Forget any time not yet simulated and restart measuring from now
+    void reset();
+
+    // ————— GETTERS ————— //
+    uint64_t const get_step_nanoseconds() const { return NANOSECONDS_IN_SECOND / m_step_rate; }
+    uint64_t const get_pending_nanoseconds() const { return m_accumulator / m_step_rate; }
+    float const get_alpha() const { return (float)((double)m_accumulator / NANOSECONDS_IN_SECOND); }  // fraction of a step pending
+    uint64_t const get_elapsed_nanoseconds() const { return m_elapsed_nanoseconds; }
+    uint64_t const get_step_count() const { return m_step_count; }
+    uint64_t const get_dropped_steps() const { return m_dropped_steps; }
+    uint64_t const get_dropped_nanoseconds() const { return m_dropped_steps * NANOSECONDS_IN_SECOND / m_step_rate; }
+    uint64_t const get_capped_frames() const { return m_capped_frames; }
+    int const get_max_catch_up_steps() const { return m_max_catch_up_steps; }
+
+    // ————— SETTERS ————— //
+    void set_max_catch_up_steps(int max_catch_up_steps) { m_max_catch_up_steps = max_catch_up_steps; }
+};
+
+#endif // FRAMECLOCK_H
@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+#include "FrameTimings.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+
+// Legacy contexts (macOS) only have the EXT flavour of timer queries
+#if !defined(GL_TIME_ELAPSED) && defined(GL_TIME_ELAPSED_EXT)
+#define GL_TIME_ELAPSED GL_TIME_ELAPSED_EXT
+#define glGetQueryObjectui64v glGetQueryObjectui64vEXT
+#endif
+
+constexpr double NANOSECONDS_IN_MILLISECOND = 1e6;
+
+FrameTimeSummary summarise(const std::vector<uint64_t>& nanoseconds, int first_frame) {
+    FrameTimeSummary summary;
+    if ((int)nanoseconds.size() <= first_frame) { return summary; }
+
+    std::vector<uint64_t> sorted(nanoseconds.begin() + first_frame, nanoseconds.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    // Nearest rank, so p99 of a short run is a frame that actually happened
+    auto percentile = [&](double fraction) {
+        size_t rank = (size_t)std::ceil(fraction * sorted.size());
+        return sorted[rank > 0 ? rank - 1 : 0] / NANOSECONDS_IN_MILLISECOND;
+    };
+
+    summary.m_count = (int)sorted.size();
+    summary.m_p50_ms = percentile(0.50);
+    summary.m_p99_ms = percentile(0.99);
+    summary.m_max_ms = sorted.back() / NANOSECONDS_IN_MILLISECOND;
+    return summary;
+}
+
+void FrameTimings::initialise() {
+#ifdef GL_TIME_ELAPSED
+    GLint counter_bits = 0;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &counter_bits);
+    m_is_gpu_supported = glGetError() == GL_NO_ERROR && counter_bits > 0;
+#else
+    m_is_gpu_supported = false;
+#endif
+
+    if (m_is_gpu_supported) glGenQueries(QUERY_COUNT, m_queries);
+    clear();
+}
+
+void FrameTimings::release() {
+    if (m_is_gpu_supported) glDeleteQueries(QUERY_COUNT, m_queries);
+    m_is_gpu_supported = false;
+    m_queries_in_flight = 0;
+}
+
+// Queries still in flight are waited for and thrown away, so the next run starts on a clean slate
+void FrameTimings::clear() {
+    collect(m_queries_in_flight);
+
+    m_cpu_nanoseconds.clear();
+    m_gpu_nanoseconds.clear();
+}
+
+void FrameTimings::begin_frame() { m_frame_start = Profiler::now(); }
+
+void FrameTimings::end_frame() {
+    MEMORY_SCOPE(MEMORY_DIAGNOSTICS);
+    m_cpu_nanoseconds.push_back(Profiler::now() - m_frame_start);
+}
+
+void FrameTimings::begin_gpu() {
+#ifdef GL_TIME_ELAPSED
+    if (!m_is_gpu_supported) { return; }
+
+    // With every slot in flight, the oldest has to come back before it can be reused
+    collect(m_queries_in_flight == QUERY_COUNT ? 1 : 0);
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[(m_oldest_query + m_queries_in_flight) % QUERY_COUNT]);
+#endif
+}
+
+void FrameTimings::end_gpu() {
+#ifdef GL_TIME_ELAPSED
+    if (!m_is_gpu_supported) { return; }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    m_queries_in_flight++;
+#endif
+}
+
+void FrameTimings::finish() { collect(m_queries_in_flight); }
+
+// Reads back queries oldest first: the first `must_collect` however long they take, then any
+// others that happen to be finished already
+void FrameTimings::collect(int must_collect) {
+#ifdef GL_TIME_ELAPSED
+    while (m_queries_in_flight > 0) {
+        GLuint query = m_queries[m_oldest_query];
+
+        if (must_collect <= 0) {
+            GLint is_available = 0;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &is_available);
+            if (!is_available) break;
+        }
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        MEMORY_SCOPE(MEMORY_DIAGNOSTICS);
+        m_gpu_nanoseconds.push_back((uint64_t)nanoseconds);
+
+        m_oldest_query = (m_oldest_query + 1) % QUERY_COUNT;
+        m_queries_in_flight--;
+        must_collect--;
+    }
+#endif
+}
+
+FrameTimeSummary FrameTimings::summarise_cpu(int first_frame) const { return summarise(m_cpu_nanoseconds, first_frame); }
+
+FrameTimeSummary FrameTimings::summarise_gpu(int first_frame) const { return summarise(m_gpu_nanoseconds, first_frame); }
@@ -0,0 +1,65 @@
+#ifndef FRAMETIMINGS_H
+#define FRAMETIMINGS_H
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <cstdint>
+#include <vector>
+
+struct FrameTimeSummary {
+    int m_count = 0;
+    double m_p50_ms = 0.0,
+           m_p99_ms = 0.0,
+           m_max_ms = 0.0;
+};
+
+// Per-frame CPU and GPU times for the frame-time harness.
+//
+// CPU time is the main thread's wall time between begin_frame() and end_frame(). GPU time comes
+// from GL_TIME_ELAPSED queries around the draw calls; a query is only read back once the GPU has
+// finished with it (a few frames later) so measuring never stalls the pipeline, and finish() waits
+// for the last few at the end. Drivers without timer queries report no GPU frames at all.
+class FrameTimings {
+private:
+    static constexpr int QUERY_COUNT = 4;   // frames the GPU may run behind before we wait on it
+
+    std::vector<uint64_t> m_cpu_nanoseconds;
+    std::vector<uint64_t> m_gpu_nanoseconds;
+    uint64_t m_frame_start = 0;
+
+    GLuint m_queries[QUERY_COUNT] = {};
+    int m_oldest_query = 0;                 // slot of the oldest query still in flight
+    int m_queries_in_flight = 0;
+    bool m_is_gpu_supported = false;
+
+    void collect(int must_collect);
+
+public:
+    // ————— METHODS ————— //
+    void initialise();                      // needs a current GL context
+    void release();
+
+    void clear();
+
+    void begin_frame();
+    void end_frame();
+    void begin_gpu();
+    void end_gpu();
+
+    void finish();
+
+    // Frames before `first_frame` are left out (warm-up)
+    FrameTimeSummary summarise_cpu(int first_frame = 0) const;
+    FrameTimeSummary summarise_gpu(int first_frame = 0) const;
+
+    // ————— GETTERS ————— //
+    bool const is_gpu_supported() const { return m_is_gpu_supported; }
+    int const get_cpu_frame_count() const { return (int)m_cpu_nanoseconds.size(); }
+    int const get_gpu_frame_count() const { return (int)m_gpu_nanoseconds.size(); }
+};
+
+#endif // FRAMETIMINGS_H
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cmath>
+#include "GravityField.h"
+#include "Entity.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+void GravityField::clear() {
+    m_sources.clear();
+    m_order.clear();
+    m_entity_sources.clear();
+    for (std::vector<Node>& nodes : m_quadrant_nodes) nodes.clear();
+}
+
+int GravityField::add_source(glm::vec2 position, float mass) {
+    m_sources.push_back(Source { position, mass, nullptr });
+    return (int)m_sources.size() - 1;
+}
+
+int GravityField::add_source(const Entity* entity, float mass) {
+    glm::vec3 position = entity->get_position();
+    m_sources.push_back(Source { glm::vec2(position.x, position.y), mass, entity });
+    m_entity_sources.push_back((int)m_sources.size() - 1);
+    return (int)m_sources.size() - 1;
+}
+
+int const GravityField::get_node_count() const {
+    int count = 0;
+    for (const std::vector<Node>& nodes : m_quadrant_nodes) count += (int)nodes.size();
+    return count;
+}
+
+// Builds the subtree over m_order[first, first + count) and returns its index in `nodes`.
+// Mass and centre of mass are summed bottom-up from the children.
+int GravityField::build_node(std::vector<Node>& nodes, int first, int count, glm::vec2 centre, float size, int depth) {
+    int index = (int)nodes.size();
+    nodes.push_back(Node { centre, centre, 0.0f, size, { -1, -1, -1, -1 }, first, 0 });
+
+    glm::vec2 weighted(0.0f);
+    float mass = 0.0f;
+
+    if (count <= MAX_LEAF_SOURCES || depth >= MAX_DEPTH) {
+        for (int i = first; i < first + count; i++) {
+            const Source& source = m_sources[m_order[i]];
+            weighted += source.m_position * source.m_mass;
+            mass += source.m_mass;
+        }
+        nodes[index].m_count = count;
+    } else {
+        // Split the range into the four quadrants: bottom-left, bottom-right, top-left, top-right
+        int* begin = &m_order[first];
+        int* end = begin + count;
+        auto below = [&](int source) { return m_sources[source].m_position.y < centre.y; };
+        auto left = [&](int source) { return m_sources[source].m_position.x < centre.x; };
+
+        int* middle = std::partition(begin, end, below);
+        int* bounds[5] = { begin, std::partition(begin, middle, left), middle, std::partition(middle, end, left), end };
+
+        float quarter = size / 4.0f;
+        for (int quadrant = 0; quadrant < 4; quadrant++) {
+            int child_count = (int)(bounds[quadrant + 1] - bounds[quadrant]);
+            if (child_count == 0) continue;
+
+            glm::vec2 child_centre = centre + glm::vec2(quadrant & 1 ? quarter : -quarter, quadrant & 2 ? quarter : -quarter);
+            int child = build_node(nodes, first + (int)(bounds[quadrant] - begin), child_count, child_centre, size / 2.0f, depth + 1);
+
+            nodes[index].m_children[quadrant] = child;
+            weighted += nodes[child].m_centre_of_mass * nodes[child].m_mass;
+            mass += nodes[child].m_mass;
+        }
+    }
+
+    nodes[index].m_mass = mass;
+    if (mass > 0.0f) nodes[index].m_centre_of_mass = weighted / mass;
+
+    return index;
+}
+
+void GravityField::build(JobSystem* job_system) {
+    MEMORY_SCOPE(MEMORY_PHYSICS);
+    int source_count = (int)m_sources.size();
+    for (std::vector<Node>& nodes : m_quadrant_nodes) nodes.clear();
+    if (source_count == 0) { return; }
+
+    // Sources riding on entities have moved since the last step
+    for (Source& source : m_sources) {
+        if (source.m_entity != nullptr) {
+            glm::vec3 position = source.m_entity->get_position();
+            source.m_position = glm::vec2(position.x, position.y);
+        }
+    }
+
+    // ––––– ROOT SQUARE ––––– //
+    glm::vec2 minimum = m_sources[0].m_position,
+              maximum = m_sources[0].m_position;
+    for (const Source& source : m_sources) {
+        minimum = glm::min(minimum, source.m_position);
+        maximum = glm::max(maximum, source.m_position);
+    }
+
+    glm::vec2 centre = (minimum + maximum) / 2.0f;
+    glm::vec2 extent = maximum - minimum;
+    float size = std::max(extent.x, extent.y) * 1.001f + 0.001f;
+
+    // ––––– SPLIT INTO QUADRANTS ––––– //
+    // A counting sort, so every quadrant owns a contiguous range of m_order its subtree can reorder
+    int counts[4] = { 0, 0, 0, 0 };
+    auto quadrant_of = [&](const Source& source) {
+        return (source.m_position.x >= centre.x ? 1 : 0) | (source.m_position.y >= centre.y ? 2 : 0);
+    };
+
+    for (const Source& source : m_sources) counts[quadrant_of(source)]++;
+
+    m_quadrant_first[0] = 0;
+    for (int quadrant = 0; quadrant < 4; quadrant++) m_quadrant_first[quadrant + 1] = m_quadrant_first[quadrant] + counts[quadrant];
+
+    int cursor[4] = { m_quadrant_first[0], m_quadrant_first[1], m_quadrant_first[2], m_quadrant_first[3] };
+    m_order.resize(source_count);
+    for (int i = 0; i < source_count; i++) m_order[cursor[quadrant_of(m_sources[i])]++] = i;
+
+    // ––––– SUBTREES ––––– //
+    float quarter = size / 4.0f;
+    auto build_quadrants = [&](int begin, int end) {
+        for (int quadrant = begin; quadrant < end; quadrant++) {
+            int count = m_quadrant_first[quadrant + 1] - m_quadrant_first[quadrant];
+            if (count == 0) continue;
+
+            glm::vec2 quadrant_centre = centre + glm::vec2(quadrant & 1 ? quarter : -quarter, quadrant & 2 ? quarter : -quarter);
+            build_node(m_quadrant_nodes[quadrant], m_quadrant_first[quadrant], count, quadrant_centre, size / 2.0f, 1);
+        }
+    };
+
+    if (job_system != nullptr && source_count >= PARALLEL_SOURCE_COUNT) {
+        job_system->parallel_for(4, 1, build_quadrants);
+    } else {
+        build_quadrants(0, 4);
+    }
+}
+
+glm::vec2 const GravityField::accumulate(const std::vector<Node>& nodes, glm::vec2 position, const Entity* ignore, const Source* ignored) const {
+    glm::vec2 acceleration(0.0f);
+    if (nodes.empty()) { return acceleration; }
+
+    float opening_angle_squared = m_opening_angle * m_opening_angle,
+          softening_squared = m_softening * m_softening;
+
+    int stack[4 * MAX_DEPTH + 4];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.m_mass == 0.0f) continue;
+
+        glm::vec2 offset = node.m_centre_of_mass - position;
+        float distance_squared = glm::dot(offset, offset) + softening_squared;
+
+        if (node.m_count > 0) {
+            // Leaf: few enough sources to add up one by one
+            for (int i = node.m_first; i < node.m_first + node.m_count; i++) {
+                const Source& source = m_sources[m_order[i]];
+                if (ignore != nullptr && source.m_entity == ignore) continue;
+
+                glm::vec2 source_offset = source.m_position - position;
+                float source_distance_squared = glm::dot(source_offset, source_offset) + softening_squared;
+                acceleration += source_offset * (source.m_mass / (source_distance_squared * sqrtf(source_distance_squared)));
+            }
+        } else if (node.m_size * node.m_size < opening_angle_squared * distance_squared &&
+                   (ignored == nullptr || fabsf(ignored->m_position.x - node.m_centre.x) > node.m_size / 2.0f ||
+                                          fabsf(ignored->m_position.y - node.m_centre.y) > node.m_size / 2.0f)) {
+            // Far enough away to act as one mass
+            acceleration += offset * (node.m_mass / (distance_squared * sqrtf(distance_squared)));
+        } else {
+            for (int child : node.m_children) {
+                if (child >= 0) stack[top++] = child;
+            }
+        }
+    }
+
+    return acceleration;
+}
+
+glm::vec3 const GravityField::acceleration_at(glm::vec3 position, const Entity* ignore) const {
+    glm::vec2 point(position.x, position.y);
+    glm::vec2 acceleration(0.0f);
+
+    // Where the body's own source was when the tree was built; it may have moved since
+    const Source* ignored = nullptr;
+    if (ignore != nullptr) {
+        for (int source : m_entity_sources) {
+            if (m_sources[source].m_entity == ignore) { ignored = &m_sources[source]; break; }
+        }
+    }
+
+    for (const std::vector<Node>& nodes : m_quadrant_nodes) acceleration += accumulate(nodes, point, ignore, ignored);
+
+    return glm::vec3(acceleration * m_gravitational_constant, 0.0f);
+}
@@ -0,0 +1,81 @@
+#ifndef GRAVITYFIELD_H
+#define GRAVITYFIELD_H
+
+#include <vector>
+#include "glm/glm.hpp"
+
+class Entity;
+class JobSystem;
+
+// Pull of every gravitating body of a level (moons, asteroids, ...) on anything that moves.
+// Sources go into a Barnes-Hut quadtree that is rebuilt every step: far-away groups of sources
+// act as a single mass at their centre of mass, so a query costs O(log N) instead of O(N).
+//
+// A group is lumped together when its size / distance is below the opening angle. 0 visits
+// every source (exact, slowest); around 0.5 is the usual trade-off; 1 and up gets rough.
+//
+// The four quadrants below the root are built as separate subtrees so they can be built on
+// different threads; queries simply start from all four.
+class GravityField {
+private:
+    struct Source {
+        glm::vec2 m_position;
+        float m_mass;
+        const Entity* m_entity;             // moves with this entity, nullptr for a fixed source
+    };
+
+    struct Node {
+        glm::vec2 m_centre;                 // of the node's square
+        glm::vec2 m_centre_of_mass;
+        float m_mass;
+        float m_size;                       // side of the node's square
+        int m_children[4];                  // -1 where a quadrant is empty
+        int m_first, m_count;               // range of m_order, used by leaves only
+    };
+
+    std::vector<Source> m_sources;
+    std::vector<int> m_order;               // source indices grouped by node
+    std::vector<int> m_entity_sources;      // the few sources bound to an entity
+    std::vector<Node> m_quadrant_nodes[4];  // each quadrant's subtree, root at index 0
+    int m_quadrant_first[5];                // range of m_order per quadrant
+
+    float m_opening_angle = DEFAULT_OPENING_ANGLE;
+    float m_gravitational_constant = 1.0f;
+    float m_softening = DEFAULT_SOFTENING;
+
+    int build_node(std::vector<Node>& nodes, int first, int count, glm::vec2 centre, float size, int depth);
+    glm::vec2 const accumulate(const std::vector<Node>& nodes, glm::vec2 position, const Entity* ignore, const Source* ignored) const;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr float DEFAULT_OPENING_ANGLE = 0.5f;
+    static constexpr float DEFAULT_SOFTENING = 0.1f;        // keeps the pull finite right on top of a source
+    static constexpr int MAX_LEAF_SOURCES = 4;
+    static constexpr int MAX_DEPTH = 24;                    // stops splitting sources that sit on top of each other
+    static constexpr int PARALLEL_SOURCE_COUNT = 256;       // below this, building on one thread is cheaper
+
+    // ————— METHODS ————— //
+    void clear();
+    int add_source(glm::vec2 position, float mass);
+    int add_source(const Entity* entity, float mass);
+
+    void build(JobSystem* job_system = nullptr);
+
+    // Acceleration at `position`, leaving out the source bound to `ignore` (a body's own mass).
+    // Nodes holding that source are always opened, so it never sneaks back in through a lumped mass.
+    glm::vec3 const acceleration_at(glm::vec3 position, const Entity* ignore = nullptr) const;
+
+    // ————— GETTERS ————— //
+    int const get_source_count() const { return (int)m_sources.size(); }
+    int const get_node_count() const;
+    float const get_opening_angle() const { return m_opening_angle; }
+    float const get_gravitational_constant() const { return m_gravitational_constant; }
+
+    // ————— SETTERS ————— //
+    void set_opening_angle(float opening_angle) { m_opening_angle = opening_angle; }
+    void set_gravitational_constant(float gravitational_constant) { m_gravitational_constant = gravitational_constant; }
+    void set_softening(float softening) { m_softening = softening; }
+    void set_source_position(int source, glm::vec2 position) { m_sources[source].m_position = position; }
+};
+
+#endif // GRAVITYFIELD_H
@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <cstring>
+#include "InputRecording.h"
+#include "MemoryTracker.h"
+
+constexpr char FILE_MAGIC[4] = { 'L', 'L', 'I', 'R' };
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+constexpr int MAX_VARINT_BYTES = 5;         // enough for any uint32_t
+
+void InputRecording::clear() {
+    m_runs.clear();
+    m_step_count = 0;
+    m_step_rate = FIXED_STEP_RATE;
+    m_outcome = OUTCOME_RUNNING;
+    m_checksum = 0;
+    m_is_playing = false;
+}
+
+void InputRecording::append(uint8_t bits, uint32_t count) {
+    MEMORY_SCOPE(MEMORY_DIAGNOSTICS);
+    m_runs.push_back({ bits, count });
+}
+
+// ––––– RECORDING ––––– //
+void InputRecording::record_step(uint8_t bits) {
+    bits &= INPUT_ACTION_MASK | INPUT_FACING_MASK;
+    m_step_count++;
+
+    InputRun* last = m_runs.empty() ? nullptr : &m_runs.back();
+    if (last != nullptr && last->m_bits == bits && last->m_count < UINT32_MAX) last->m_count++;
+    else append(bits, 1);
+}
+
+void InputRecording::record_restart() { append(INPUT_RESTART, 1); }
+
+void InputRecording::record_rewind(int ticks) { append(INPUT_REWIND, (uint32_t)ticks); }
+
+// ––––– FILES ––––– //
+bool write_varint(FILE* file, uint32_t value) {
+    uint8_t bytes[MAX_VARINT_BYTES];
+    int count = 0;
+    do {
+        bytes[count] = value & 0x7f;
+        value >>= 7;
+        if (value != 0) bytes[count] |= 0x80;
+        count++;
+    } while (value != 0);
+    return fwrite(bytes, 1, count, file) == (size_t)count;
+}
+
+bool read_varint(FILE* file, uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < MAX_VARINT_BYTES; i++) {
+        int byte = fgetc(file);
+        if (byte == EOF) { return false; }
+
+        value |= (uint32_t)(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) { return true; }
+    }
+    return false;
+}
+
+bool InputRecording::save(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) { return false; }
+
+    bool ok = fwrite(FILE_MAGIC, 1, sizeof(FILE_MAGIC), file) == sizeof(FILE_MAGIC) &&
+              fwrite(&FILE_VERSION, sizeof(FILE_VERSION), 1, file) == 1 &&
+              fwrite(&m_step_rate, sizeof(m_step_rate), 1, file) == 1;
+
+    for (size_t i = 0; ok && i < m_runs.size(); i++) {
+        const InputRun& run = m_runs[i];
+        ok = fputc(run.m_bits, file) != EOF;
+        if (ok && run.m_bits != INPUT_RESTART) ok = write_varint(file, run.m_count);
+    }
+
+    uint8_t outcome = (uint8_t)m_outcome;
+    ok = ok && fputc(INPUT_END, file) != EOF &&
+         fwrite(&outcome, sizeof(outcome), 1, file) == 1 &&
+         fwrite(&m_step_count, sizeof(m_step_count), 1, file) == 1 &&
+         fwrite(&m_checksum, sizeof(m_checksum), 1, file) == 1;
+
+    return fclose(file) == 0 && ok;
+}
+
+bool InputRecording::load(const char* path) {
+    clear();
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) { return false; }
+
+    char magic[sizeof(FILE_MAGIC)];
+    uint32_t version = 0;
+    bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, FILE_MAGIC, sizeof(magic)) == 0 &&
+              fread(&version, sizeof(version), 1, file) == 1 && version == FILE_VERSION &&
+              fread(&m_step_rate, sizeof(m_step_rate), 1, file) == 1;
+
+    uint64_t step_count = 0;
+    while (ok) {
+        int bits = fgetc(file);
+        if (bits == EOF || bits == INPUT_END) {
+            ok = bits == INPUT_END;
+            break;
+        }
+
+        uint32_t count = 1;
+        if (bits != INPUT_RESTART) ok = read_varint(file, count);
+        if (!(bits & INPUT_EVENT_MASK)) step_count += count;
+        append((uint8_t)bits, count);
+    }
+
+    uint8_t outcome = OUTCOME_RUNNING;
+    ok = ok && fread(&outcome, sizeof(outcome), 1, file) == 1 &&
+         fread(&m_step_count, sizeof(m_step_count), 1, file) == 1 &&
+         fread(&m_checksum, sizeof(m_checksum), 1, file) == 1 &&
+         m_step_count == step_count;
+    m_outcome = (BatchOutcome)outcome;
+
+    fclose(file);
+    if (!ok) clear();
+    return ok;
+}
+
+// ––––– PLAYBACK ––––– //
+void InputRecording::start_playback() {
+    m_is_playing = true;
+    m_next_run = 0;
+    m_run_position = 0;
+}
+
+bool InputRecording::next(uint8_t& bits, uint32_t& argument) {
+    if (!m_is_playing || m_next_run >= m_runs.size()) { return false; }
+
+    const InputRun& run = m_runs[m_next_run];
+    bits = run.m_bits;
+    argument = run.m_count;
+
+    // Events are taken whole, steps one at a time
+    if ((run.m_bits & INPUT_EVENT_MASK) || ++m_run_position >= run.m_count) {
+        m_next_run++;
+        m_run_position = 0;
+    }
+    return true;
+}
+
+uint64_t InputRecording::checksum(const void* data, size_t size, uint64_t checksum) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        checksum ^= bytes[i];
+        checksum *= FNV_PRIME;
+    }
+    return checksum;
+}
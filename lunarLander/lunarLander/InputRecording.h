@@ -0,0 +1,89 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BatchSimulation.h"
+
+// A step's byte holds the BatchAction bits of the player's movement and, above them, the
+// AnimationDirection it faces (which picks its collision mask). Level changes that are not steps
+// use the top two bits.
+constexpr uint8_t INPUT_ACTION_MASK = ACTION_LEFT | ACTION_RIGHT | ACTION_UP | ACTION_DOWN;
+constexpr int INPUT_FACING_SHIFT = 4;
+constexpr uint8_t INPUT_FACING_MASK = 3 << INPUT_FACING_SHIFT;
+
+enum InputEvent : uint8_t {
+    INPUT_RESTART = 1 << 6,
+    INPUT_REWIND  = 1 << 7,                 // the run's count is the ticks rewound
+    INPUT_END     = INPUT_RESTART | INPUT_REWIND,   // after the last run, in files only
+};
+
+constexpr uint8_t INPUT_EVENT_MASK = INPUT_RESTART | INPUT_REWIND;
+
+// One step's input, repeated m_count times; or, with an InputEvent bit set, one restart or rewind
+struct InputRun {
+    uint8_t m_bits;
+    uint32_t m_count;
+};
+
+// Everything the simulation was fed, one entry per fixed step in the order the steps ran, so a
+// replay goes through the same steps with the same input and ends in the same state. Steps hold
+// the player's movement and facing as they were when the step began; restarts and rewinds sit
+// between the steps they happened between. Consecutive steps with equal input collapse into one
+// run, and a minute of play is typically a few dozen runs.
+//
+// File (little-endian): "LLIR", uint32 version, uint32 step rate, then runs as one byte of bits
+// and a LEB128 count (restarts have no count), then INPUT_END and the result: uint8 outcome
+// (BatchOutcome), uint64 steps, uint64 state checksum.
+class InputRecording {
+private:
+    std::vector<InputRun> m_runs;
+    uint64_t m_step_count = 0;
+    uint32_t m_step_rate = FIXED_STEP_RATE;
+
+    BatchOutcome m_outcome = OUTCOME_RUNNING;
+    uint64_t m_checksum = 0;
+
+    // ————— PLAYBACK ————— //
+    bool m_is_playing = false;
+    size_t m_next_run = 0;
+    uint32_t m_run_position = 0;            // steps already taken from m_runs[m_next_run]
+
+    void append(uint8_t bits, uint32_t count);
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr uint32_t FILE_VERSION = 1;
+    static constexpr uint64_t CHECKSUM_SEED = 14695981039346656037ull;     // FNV-1a offset basis
+
+    // ————— METHODS ————— //
+    void clear();
+
+    void record_step(uint8_t bits);
+    void record_restart();
+    void record_rewind(int ticks);
+    void set_result(BatchOutcome outcome, uint64_t checksum) { m_outcome = outcome; m_checksum = checksum; }
+
+    bool save(const char* path) const;
+    bool load(const char* path);
+
+    // Hands out the entries one step or event at a time: the bits, and for a rewind its ticks.
+    // False once the recording is used up.
+    void start_playback();
+    bool next(uint8_t& bits, uint32_t& argument);
+    void stop_playback() { m_is_playing = false; }
+
+    // FNV-1a, chained through `checksum` to cover several pieces of state
+    static uint64_t checksum(const void* data, size_t size, uint64_t checksum = CHECKSUM_SEED);
+
+    // ————— GETTERS ————— //
+    bool const is_playing() const { return m_is_playing; }
+    uint64_t const get_step_count() const { return m_step_count; }
+    uint32_t const get_step_rate() const { return m_step_rate; }
+    int const get_run_count() const { return (int)m_runs.size(); }
+    BatchOutcome const get_outcome() const { return m_outcome; }
+    uint64_t const get_checksum() const { return m_checksum; }
+};
+
+#endif // INPUTRECORDING_H
@@ -0,0 +1,71 @@
+#include <cstring>
+#include "InputScript.h"
+#include "FrameClock.h"
+
+// The arrow key each BatchAction bit stands for, lowest bit first
+constexpr SDL_Scancode ACTION_SCANCODES[] = { SDL_SCANCODE_LEFT, SDL_SCANCODE_RIGHT, SDL_SCANCODE_UP, SDL_SCANCODE_DOWN };
+constexpr int ACTION_KEY_COUNT = sizeof(ACTION_SCANCODES) / sizeof(ACTION_SCANCODES[0]);
+
+void InputScript::start(const Scenario* scenario) {
+    stop();
+    m_scenario = scenario;
+}
+
+// Lets go of whatever the script was holding
+void InputScript::stop() {
+    m_scenario = nullptr;
+    m_frame = 0;
+    m_held_actions = ACTION_NONE;
+
+    memset(m_keyboard_state, 0, sizeof(m_keyboard_state));
+    m_events.clear();
+    m_next_event = 0;
+}
+
+void InputScript::press(SDL_Scancode scancode, bool is_down) {
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = is_down ? SDL_KEYDOWN : SDL_KEYUP;
+    event.key.state = is_down ? SDL_PRESSED : SDL_RELEASED;
+    event.key.keysym.scancode = scancode;
+    event.key.keysym.sym = SDL_GetKeyFromScancode(scancode);
+
+    m_events.push_back(event);
+    m_keyboard_state[scancode] = is_down ? 1 : 0;
+}
+
+void InputScript::begin_frame() {
+    m_events.clear();
+    m_next_event = 0;
+    if (m_scenario == nullptr) { return; }
+
+    uint8_t actions = ACTION_NONE;
+    for (int i = 0; i < m_scenario->m_input_count; i++) {
+        const ScriptedInput& input = m_scenario->m_inputs[i];
+        if (m_frame >= input.m_first_frame && m_frame < input.m_first_frame + input.m_frame_count) actions |= input.m_actions;
+    }
+
+    uint8_t changed = actions ^ m_held_actions;
+    for (int key = 0; key < ACTION_KEY_COUNT; key++) {
+        if (changed & (1 << key)) press(ACTION_SCANCODES[key], (actions & (1 << key)) != 0);
+    }
+
+    m_held_actions = actions;
+    m_frame++;
+}
+
+bool InputScript::poll_event(SDL_Event* event) {
+    if (m_next_event >= m_events.size()) { return false; }
+
+    *event = m_events[m_next_event++];
+    return true;
+}
+
+uint64_t const InputScript::get_frame_nanoseconds() const {
+    if (m_frame == 0) { return 0; }
+
+    // Frame n ends at n / FIXED_STEP_RATE seconds, rounded up: rounding down would leave the step
+    // accumulator a few units short of a whole step and the steps would bunch up 0, 1, 2
+    auto frame_end = [](uint64_t frame) { return (frame * FrameClock::NANOSECONDS_IN_SECOND + FIXED_STEP_RATE - 1) / FIXED_STEP_RATE; };
+    return frame_end((uint64_t)m_frame) - frame_end((uint64_t)m_frame - 1);
+}
@@ -0,0 +1,45 @@
+#ifndef INPUTSCRIPT_H
+#define INPUTSCRIPT_H
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+#include "Scenarios.h"
+
+// Plays a Scenario's input timeline in place of the keyboard. Each frame begin_frame() works out
+// which keys the script holds, queues SDL_KEYDOWN/SDL_KEYUP events for the ones that changed, and
+// updates a keyboard state array, so process_input() reads the script exactly the way it reads
+// SDL_PollEvent and SDL_GetKeyboardState.
+//
+// The script also keeps its own clock: get_frame_nanoseconds() is the length of the current frame
+// at FIXED_STEP_RATE frames a second, carried in integers so every frame is exactly one step.
+class InputScript {
+private:
+    const Scenario* m_scenario = nullptr;
+    int m_frame = 0;                        // frames begun so far
+    uint8_t m_held_actions = ACTION_NONE;
+
+    Uint8 m_keyboard_state[SDL_NUM_SCANCODES] = {};
+    std::vector<SDL_Event> m_events;        // this frame's, handed out by poll_event()
+    size_t m_next_event = 0;
+
+    void press(SDL_Scancode scancode, bool is_down);
+
+public:
+    // ————— METHODS ————— //
+    void start(const Scenario* scenario);
+    void stop();
+
+    void begin_frame();
+    bool poll_event(SDL_Event* event);
+
+    // ————— GETTERS ————— //
+    bool const is_playing() const { return m_scenario != nullptr; }
+    bool const is_finished() const { return m_scenario != nullptr && m_frame >= m_scenario->m_frame_count; }
+    const Scenario* get_scenario() const { return m_scenario; }
+    int const get_frame() const { return m_frame; }
+    const Uint8* get_keyboard_state() const { return m_keyboard_state; }
+    uint64_t const get_frame_nanoseconds() const;
+};
+
+#endif // INPUTSCRIPT_H
@@ -0,0 +1,226 @@
+#include <cstdio>
+#include <memory>
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+
+// Which queue the current thread owns, and for which job system
+thread_local int t_queue_index = 0;
+thread_local const JobSystem* t_owner = nullptr;
+
+JobSystem::~JobSystem() { shutdown(); }
+
+void JobSystem::initialise(int worker_count) {
+    if (m_is_running) { return; }
+    MEMORY_SCOPE(MEMORY_JOBS);
+
+    if (worker_count <= 0) {
+        int hardware_threads = (int)std::thread::hardware_concurrency();
+        worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+    }
+
+    for (int i = 0; i < worker_count + 1; i++) m_queues.push_back(new WorkQueue());
+
+    t_owner = this;
+    t_queue_index = 0;
+    m_is_running = true;
+
+    for (int i = 0; i < worker_count; i++) {
+        m_workers.emplace_back(&JobSystem::worker_loop, this, i + 1);
+    }
+}
+
+void JobSystem::shutdown() {
+    if (!m_is_running) { return; }
+
+    // Let everything that was already queued finish before the workers go away
+    Job job;
+    while (m_queued_jobs.load() > 0) {
+        if (pop_or_steal(current_queue(), job)) execute(job);
+        else std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_is_running = false;
+    }
+    m_wake_condition.notify_all();
+
+    for (std::thread& worker : m_workers) worker.join();
+    m_workers.clear();
+
+    for (WorkQueue* queue : m_queues) delete queue;
+    m_queues.clear();
+
+    if (t_owner == this) t_owner = nullptr;
+}
+
+int const JobSystem::current_queue() const {
+    return t_owner == this ? t_queue_index : 0;
+}
+
+void JobSystem::worker_loop(int queue_index) {
+    MEMORY_SCOPE(MEMORY_JOBS);              // unless a job opens a scope of its own
+    t_owner = this;
+    t_queue_index = queue_index;
+
+    char name[Profiler::MAX_THREAD_NAME];
+    snprintf(name, sizeof(name), "Job worker %d", queue_index);
+    g_profiler.set_thread_name(name);
+
+    Job job;
+    while (m_is_running) {
+        if (pop_or_steal(queue_index, job)) {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_wake_condition.wait(lock, [this] { return m_queued_jobs.load() > 0 || !m_is_running; });
+    }
+}
+
+void JobSystem::push(Job job) {
+    int queue_index = current_queue();
+
+    // Threads without a queue of their own spread their work round-robin
+    if (t_owner != this || queue_index == 0) {
+        queue_index = (int)(m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_queues[queue_index]->m_mutex);
+        m_queues[queue_index]->m_jobs.push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_queued_jobs.fetch_add(1);
+    }
+    m_wake_condition.notify_one();
+}
+
+bool JobSystem::pop_or_steal(int queue_index, Job& job) {
+    int queue_count = (int)m_queues.size();
+    if (queue_count == 0) { return false; }
+
+    {
+        WorkQueue* own = m_queues[queue_index];
+        std::lock_guard<std::mutex> lock(own->m_mutex);
+        if (!own->m_jobs.empty()) {
+            job = std::move(own->m_jobs.back());
+            own->m_jobs.pop_back();
+            m_queued_jobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (int offset = 1; offset < queue_count; offset++) {
+        WorkQueue* victim = m_queues[(queue_index + offset) % queue_count];
+        std::lock_guard<std::mutex> lock(victim->m_mutex);
+        if (!victim->m_jobs.empty()) {
+            job = std::move(victim->m_jobs.front());
+            victim->m_jobs.pop_front();
+            m_queued_jobs.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(Job& job) {
+    job.m_function();
+    finish(job.m_counter);
+    job = Job();
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (counter == nullptr) { return; }
+
+    // The decrement happens under the lock so that `wait` can tell when we are done touching
+    // the counter (it may live on the waiter's stack). The last job releases the continuations.
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_continuation_mutex);
+        if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) { return; }
+        continuations.swap(counter->m_continuations);
+    }
+    for (std::function<void()>& continuation : continuations) continuation();
+}
+
+void JobSystem::submit(std::function<void()> job, JobCounter* counter) {
+    if (counter != nullptr) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (!m_is_running) {
+        // Not initialised: behave like a plain function call
+        job();
+        finish(counter);
+        return;
+    }
+
+    push(Job { std::move(job), counter });
+}
+
+void JobSystem::submit_after(JobCounter* dependency, std::function<void()> job, JobCounter* counter) {
+    if (dependency == nullptr) {
+        submit(std::move(job), counter);
+        return;
+    }
+
+    if (counter != nullptr) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(dependency->m_continuation_mutex);
+        if (!dependency->is_done()) {
+            dependency->m_continuations.push_back([this, job = std::move(job), counter]() mutable {
+                if (m_is_running) push(Job { std::move(job), counter });
+                else { job(); finish(counter); }
+            });
+            return;
+        }
+    }
+
+    // Dependency already satisfied
+    if (m_is_running) push(Job { std::move(job), counter });
+    else { job(); finish(counter); }
+}
+
+void JobSystem::parallel_for(int count, int chunk_size, const std::function<void(int, int)>& body, JobCounter* counter) {
+    if (count <= 0) { return; }
+    if (chunk_size <= 0) chunk_size = DEFAULT_CHUNK_SIZE;
+
+    // Not worth a trip through the queues
+    if (m_workers.empty() || count <= chunk_size) {
+        if (counter != nullptr) counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+        body(0, count);
+        finish(counter);
+        return;
+    }
+
+    JobCounter local_counter;
+    JobCounter* batch_counter = counter != nullptr ? counter : &local_counter;
+
+    // The caller may return before the chunks run when it passes its own counter
+    auto shared_body = std::make_shared<std::function<void(int, int)>>(body);
+
+    for (int begin = 0; begin < count; begin += chunk_size) {
+        int end = begin + chunk_size < count ? begin + chunk_size : count;
+        submit([shared_body, begin, end]() { (*shared_body)(begin, end); }, batch_counter);
+    }
+
+    if (counter == nullptr) wait(&local_counter);
+}
+
+void JobSystem::wait(JobCounter* counter) {
+    if (counter == nullptr) { return; }
+
+    Job job;
+    while (!counter->is_done()) {
+        if (pop_or_steal(current_queue(), job)) execute(job);
+        else std::this_thread::yield();
+    }
+
+    // Wait for the finishing thread to let go of the counter before the caller can destroy it
+    std::lock_guard<std::mutex> lock(counter->m_continuation_mutex);
+}
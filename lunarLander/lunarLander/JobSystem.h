@@ -0,0 +1,90 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the jobs still outstanding for a batch of work. Jobs submitted with a counter
+// increment it, and finishing them decrements it; `wait` and `submit_after` key off zero.
+class JobCounter {
+private:
+    friend class JobSystem;
+
+    std::atomic<int> m_pending{0};
+    std::mutex m_continuation_mutex;
+    std::vector<std::function<void()>> m_continuations;
+
+public:
+    bool const is_done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+};
+
+class JobSystem {
+private:
+    struct Job {
+        std::function<void()> m_function;
+        JobCounter* m_counter = nullptr;
+    };
+
+    // One deque per thread. The owner pushes and pops at the back (LIFO, cache-warm),
+    // idle threads steal from the front of somebody else's.
+    struct WorkQueue {
+        std::mutex m_mutex;
+        std::deque<Job> m_jobs;
+    };
+
+    std::vector<std::thread> m_workers;
+    std::vector<WorkQueue*> m_queues;       // index 0 belongs to the thread that called initialise()
+
+    std::atomic<bool> m_is_running{false};
+    std::atomic<int> m_queued_jobs{0};
+    std::atomic<unsigned> m_next_queue{0};
+
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake_condition;
+
+    void worker_loop(int queue_index);
+    void push(Job job);
+    bool pop_or_steal(int queue_index, Job& job);
+    void execute(Job& job);
+    void finish(JobCounter* counter);
+    int const current_queue() const;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int DEFAULT_CHUNK_SIZE = 64;
+
+    // ————— METHODS ————— //
+    JobSystem() = default;
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // worker_count <= 0 uses one worker per hardware thread, minus the calling thread
+    void initialise(int worker_count = 0);
+    void shutdown();
+
+    void submit(std::function<void()> job, JobCounter* counter = nullptr);
+
+    // Runs `job` once `dependency` has drained; the job itself is tracked by `counter`
+    void submit_after(JobCounter* dependency, std::function<void()> job, JobCounter* counter = nullptr);
+
+    // Splits [0, count) into chunks of `chunk_size` and calls body(begin, end) for each.
+    // Blocks until every chunk has run unless a counter is supplied.
+    void parallel_for(int count, int chunk_size, const std::function<void(int, int)>& body, JobCounter* counter = nullptr);
+
+    // Runs queued jobs on the calling thread until the counter reaches zero
+    void wait(JobCounter* counter);
+
+    // ————— GETTERS ————— //
+    int const get_worker_count() const { return (int)m_workers.size(); }
+    int const get_thread_count() const { return (int)m_workers.size() + 1; }
+    bool const is_running() const { return m_is_running.load(); }
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,103 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <cmath>
+#include "EntityType.h"
+
+// ————— LEVEL LAYOUT ————— //
+// Plain data so the game, the headless batch simulation and the analysis tools all build
+// the same level. Collision boxes are hand-tuned and deliberately smaller than the sprites.
+struct PlatformLayout {
+    EntityType m_type;
+    float m_x, m_y;
+    float m_width, m_height;                // collision box
+    float m_sprite_width, m_sprite_height;  // how large the sprite is drawn
+};
+
+constexpr int PLATFORM_COUNT = 5;
+
+constexpr PlatformLayout LEVEL_PLATFORMS[PLATFORM_COUNT] = {
+    // ––––– SHROOMS ––––– //
+    { SHROOM, -3.5f,  -1.75f, 0.0f,  0.5f, 0.765f, 0.765f },
+    { SHROOM,  3.5f,  -1.75f, 0.0f,  0.5f, 0.765f, 0.765f },
+    { SHROOM,  0.0f,  -1.75f, 0.0f,  0.5f, 0.765f, 0.765f },
+    // ––––– PCS ––––– //
+    { PC,     -1.95f, -3.15f, 0.25f, 1.0f, 1.128f, 1.114f },
+    { PC,      1.95f, -3.15f, 0.25f, 1.0f, 1.128f, 1.114f },
+};
+
+// ————— TERRAIN ————— //
+// Ground along the bottom of the screen. Pad edges should sit on column boundaries
+// ((right - left) / TERRAIN_COLUMNS apart); the terrain snaps them to the nearest one otherwise.
+struct PadLayout {
+    float m_left, m_right;
+    float m_y;
+};
+
+constexpr int TERRAIN_COLUMNS = 80,
+              PAD_COUNT = 2;
+
+constexpr float TERRAIN_LEFT = -5.0f,
+                TERRAIN_RIGHT = 5.0f,
+                TERRAIN_BASE = -3.55f,          // average height of the rough ground
+                TERRAIN_ROUGHNESS = 0.12f,      // how far hills rise above and dip below the base
+                TERRAIN_FLOOR = -3.75f;         // bottom edge of the screen
+
+// Height of the rough ground before the pads flatten it. A few sines of unrelated wavelengths look
+// irregular enough and need no random state.
+inline float terrain_height(float x, float base, float roughness) {
+    float wave = 0.55f * sinf(x * 1.3f) + 0.3f * sinf(x * 3.7f + 1.1f) + 0.15f * sinf(x * 8.9f + 2.3f);
+    return base + roughness * wave;
+}
+
+// 12 columns each, so the lander fits on a pad with room to spare either side
+constexpr PadLayout LEVEL_PADS[PAD_COUNT] = {
+    { -4.875f, -3.375f, -3.5f },
+    {  3.375f,  4.875f, -3.5f },
+};
+
+// ————— GRAVITY ————— //
+// Bodies that pull on everything that moves, on top of the lander's own "gravity". Kept light:
+// the moon pulls about 0.006 sideways at the start, far below the braking the controls apply,
+// so the level flies as it was tuned.
+struct AttractorLayout {
+    float m_x, m_y;
+    float m_mass;
+};
+
+constexpr int ATTRACTOR_COUNT = 1;
+
+constexpr AttractorLayout LEVEL_ATTRACTORS[ATTRACTOR_COUNT] = {
+    { 9.0f, 2.0f, 0.5f },       // a small moon just off the right edge of the screen
+};
+
+constexpr float GRAVITATIONAL_CONSTANT = 1.0f;
+
+// ————— PLAYER ————— //
+constexpr float PLAYER_START_X = 0.0f,
+                PLAYER_START_Y = 0.0f,
+                PLAYER_SPEED = 3.0f,
+                PLAYER_JUMPING_POWER = 3.0f,
+                PLAYER_WIDTH = 0.9f,
+                PLAYER_HEIGHT = 0.9f,
+                PLAYER_FUEL = 75.0f,
+                PLAYER_GRAVITY = -4.905f;
+
+// A landing only counts when the whole footprint is on one pad, so every pad has to be wider than
+// the lander, and its edges have to sit on column boundaries to be where the layout says
+constexpr bool pads_fit_lander() {
+    float column_width = (TERRAIN_RIGHT - TERRAIN_LEFT) / TERRAIN_COLUMNS;
+    for (const PadLayout& pad : LEVEL_PADS) {
+        float first = (pad.m_left - TERRAIN_LEFT) / column_width,
+              last = (pad.m_right - TERRAIN_LEFT) / column_width;
+        if (pad.m_right - pad.m_left <= PLAYER_WIDTH || first != (float)(int)first || last != (float)(int)last) return false;
+    }
+    return true;
+}
+
+static_assert(pads_fit_lander(), "the lander has to fit on every pad");
+
+constexpr float FIXED_TIMESTEP = 0.0166666f;
+constexpr int FIXED_STEP_RATE = 60;          // steps per second the frame clock hands out
+
+#endif // LEVEL_H
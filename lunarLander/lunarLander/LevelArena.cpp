@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <cstring>
+#include "LevelArena.h"
+
+thread_local LevelArena* t_current_arena = nullptr;
+
+LevelArena::LevelArena(size_t block_size) : m_block_size(block_size) {
+    add_block(block_size);
+}
+
+LevelArena::~LevelArena() {
+    for (Block& block : m_blocks) delete [] block.m_memory;
+}
+
+void LevelArena::add_block(size_t minimum_size) {
+    size_t capacity = minimum_size > m_block_size ? minimum_size : m_block_size;
+    m_blocks.push_back(Block { new char[capacity], capacity });
+}
+
+void* LevelArena::allocate(size_t size, size_t alignment) {
+    // Walk forward through the retained blocks until one fits, only then grow
+    while (true) {
+        Block& block = m_blocks[m_current_block];
+        uintptr_t base = (uintptr_t)block.m_memory;
+        uintptr_t aligned = (base + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        size_t end = (size_t)(aligned - base) + size;
+
+        if (end <= block.m_capacity) {
+            m_bytes_used += end - m_offset;
+            m_offset = end;
+            if (m_bytes_used > m_peak_bytes) m_peak_bytes = m_bytes_used;
+
+            m_allocation_count++;
+            m_total_allocation_count++;
+            return (void*)aligned;
+        }
+
+        if (m_current_block + 1 == (int)m_blocks.size()) add_block(size + alignment);
+        m_current_block++;
+        m_offset = 0;
+    }
+}
+
+void LevelArena::reset() {
+    m_current_block = 0;
+    m_offset = 0;
+    m_bytes_used = 0;
+    m_allocation_count = 0;
+    m_reset_count++;
+}
+
+bool const LevelArena::owns(const void* pointer) const {
+    for (const Block& block : m_blocks) {
+        if (pointer >= block.m_memory && pointer < block.m_memory + block.m_capacity) return true;
+    }
+    return false;
+}
+
+// Blocks before the current one are copied whole; the tail they skipped is never handed out
+size_t const LevelArena::get_snapshot_size() const {
+    size_t size = m_offset;
+    for (int i = 0; i < m_current_block; i++) size += m_blocks[i].m_capacity;
+    return size;
+}
+
+void LevelArena::save(void* destination) const {
+    char* cursor = static_cast<char*>(destination);
+    for (int i = 0; i < m_current_block; i++) {
+        memcpy(cursor, m_blocks[i].m_memory, m_blocks[i].m_capacity);
+        cursor += m_blocks[i].m_capacity;
+    }
+    memcpy(cursor, m_blocks[m_current_block].m_memory, m_offset);
+}
+
+void LevelArena::restore(const void* source) {
+    const char* cursor = static_cast<const char*>(source);
+    for (int i = 0; i < m_current_block; i++) {
+        memcpy(m_blocks[i].m_memory, cursor, m_blocks[i].m_capacity);
+        cursor += m_blocks[i].m_capacity;
+    }
+    memcpy(m_blocks[m_current_block].m_memory, cursor, m_offset);
+}
+
+size_t const LevelArena::get_capacity() const {
+    size_t capacity = 0;
+    for (const Block& block : m_blocks) capacity += block.m_capacity;
+    return capacity;
+}
+
+LevelArena* LevelArena::current() { return t_current_arena; }
+
+LevelArena::ArenaScope::ArenaScope(LevelArena* arena) : m_previous(t_current_arena) {
+    t_current_arena = arena;
+}
+
+LevelArena::ArenaScope::~ArenaScope() { t_current_arena = m_previous; }
@@ -0,0 +1,96 @@
+#ifndef LEVELARENA_H
+#define LEVELARENA_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Bump allocator for everything that lives exactly as long as a level. Allocations are packed
+// into large blocks and the whole level is released at once by rewinding to the first block;
+// blocks are kept for the next level so reloading never goes back to the heap.
+//
+// Everything a level allocates sits in a few known byte ranges, so the whole level can be saved
+// and restored with a memcpy per block in use (one for any normal level). A snapshot stays valid
+// until the next reset(), because restoring puts every object back at the same address.
+//
+// reset() does not run destructors. Only create types whose resources also come from the
+// arena (Entity picks its components from the current arena) or that are trivially destructible.
+class LevelArena {
+private:
+    struct Block {
+        char* m_memory;
+        size_t m_capacity;
+    };
+
+    std::vector<Block> m_blocks;
+    int m_current_block = 0;
+    size_t m_offset = 0;
+    size_t m_block_size;
+
+    // ————— STATISTICS ————— //
+    size_t m_bytes_used = 0;
+    size_t m_peak_bytes = 0;
+    int m_allocation_count = 0;
+    int m_total_allocation_count = 0;
+    int m_reset_count = 0;
+
+    void add_block(size_t minimum_size);
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    // ————— METHODS ————— //
+    explicit LevelArena(size_t block_size = DEFAULT_BLOCK_SIZE);
+    ~LevelArena();
+
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void reset();
+    bool const owns(const void* pointer) const;
+
+    size_t const get_snapshot_size() const;
+    void save(void* destination) const;         // get_snapshot_size() bytes
+    void restore(const void* source);           // only snapshots taken since the last reset()
+
+    // Allocations made while constructing these objects (e.g. entity components) also land here
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        ArenaScope scope(this);
+        void* memory = allocate(sizeof(T), alignof(T));
+        return new (memory) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T* create_array(int count) {
+        ArenaScope scope(this);
+        T* objects = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        for (int i = 0; i < count; i++) new (&objects[i]) T();
+        return objects;
+    }
+
+    // The arena objects should take their own allocations from, if any
+    static LevelArena* current();
+
+    class ArenaScope {
+    private:
+        LevelArena* m_previous;
+    public:
+        explicit ArenaScope(LevelArena* arena);
+        ~ArenaScope();
+    };
+
+    // ————— GETTERS ————— //
+    size_t const get_bytes_used() const { return m_bytes_used; }
+    size_t const get_peak_bytes() const { return m_peak_bytes; }
+    size_t const get_capacity() const;
+    int const get_allocation_count() const { return m_allocation_count; }
+    int const get_total_allocation_count() const { return m_total_allocation_count; }
+    int const get_block_count() const { return (int)m_blocks.size(); }
+    int const get_reset_count() const { return m_reset_count; }
+};
+
+#endif // LEVELARENA_H
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <memory>
+#include "Logger.h"
+#include "MemoryTracker.h"
+
+Logger g_logger;
+
+struct LogRecord {
+    uint64_t m_time;
+    LogSeverity m_severity;
+    uint32_t m_suppressed;
+    char m_message[Logger::MESSAGE_SIZE];
+};
+
+// Single producer (the owning thread), single consumer (whoever holds the drain mutex)
+struct LogThreadRing {
+    std::unique_ptr<LogRecord[]> m_records{new LogRecord[Logger::RING_CAPACITY]};
+    std::atomic<uint64_t> m_head{0};        // records written, only the owner advances it
+    std::atomic<uint64_t> m_tail{0};        // records drained, only the consumer advances it
+    std::atomic<uint64_t> m_dropped{0};
+    int m_thread_id = 0;
+};
+
+// The ring the current thread logs into, and for which logger
+thread_local LogThreadRing* t_log_ring = nullptr;
+thread_local const Logger* t_log_owner = nullptr;
+
+constexpr const char* SEVERITY_NAMES[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+
+bool LogRateLimit::allow(uint32_t& suppressed) {
+    uint64_t time = Logger::now(),
+             next_allowed = m_next_allowed.load(std::memory_order_relaxed);
+
+    // Of several threads racing for the same slot, only the one that moves it forward logs
+    if (time < next_allowed || !m_next_allowed.compare_exchange_strong(next_allowed, time + m_interval, std::memory_order_relaxed)) {
+        m_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+Logger::~Logger() {
+    shutdown();
+    for (LogThreadRing* ring : m_rings) delete ring;
+    m_rings.clear();
+}
+
+LogThreadRing* Logger::thread_ring() {
+    if (t_log_owner == this) { return t_log_ring; }
+    MEMORY_SCOPE(MEMORY_LOGGING);
+
+    LogThreadRing* ring = new LogThreadRing();
+    {
+        std::lock_guard<std::mutex> lock(m_rings_mutex);
+        ring->m_thread_id = (int)m_rings.size() + 1;
+        m_rings.push_back(ring);
+    }
+
+    t_log_owner = this;
+    t_log_ring = ring;
+    return ring;
+}
+
+bool Logger::start(const char* path) {
+    if (m_is_running) { return true; }
+
+    if (path != nullptr) {
+        m_output = fopen(path, "w");
+        if (m_output == nullptr) { return false; }
+        m_owns_output = true;
+    } else {
+        m_output = stdout;
+        m_owns_output = false;
+    }
+
+    m_is_running = true;
+    m_drain_thread = std::thread(&Logger::drain_loop, this);
+    return true;
+}
+
+void Logger::shutdown() {
+    if (!m_is_running) { return; }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_is_running = false;
+    }
+    m_wake_condition.notify_all();
+    m_drain_thread.join();
+
+    // Whatever arrived after the last pass
+    drain();
+
+    if (m_owns_output) fclose(m_output);
+    m_output = nullptr;
+    m_owns_output = false;
+}
+
+void Logger::flush() {
+    if (m_output != nullptr) drain();
+}
+
+uint64_t const Logger::get_dropped_count() const {
+    std::lock_guard<std::mutex> lock(m_rings_mutex);
+    uint64_t count = 0;
+    for (const LogThreadRing* ring : m_rings) count += ring->m_dropped.load(std::memory_order_relaxed);
+    return count;
+}
+
+// ––––– PRODUCING ––––– //
+void Logger::write(LogSeverity severity, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    write_arguments(severity, 0, format, arguments);
+    va_end(arguments);
+}
+
+void Logger::write_limited(LogSeverity severity, LogRateLimit& limit, const char* format, ...) {
+    uint32_t suppressed = 0;
+    if (!limit.allow(suppressed)) { return; }
+
+    va_list arguments;
+    va_start(arguments, format);
+    write_arguments(severity, suppressed, format, arguments);
+    va_end(arguments);
+}
+
+void Logger::write_arguments(LogSeverity severity, uint32_t suppressed, const char* format, va_list arguments) {
+    uint64_t time = now();
+
+    // Nobody draining: straight out, the way std::cout used to
+    if (!m_is_running.load(std::memory_order_relaxed)) {
+        char message[MESSAGE_SIZE], line[MESSAGE_SIZE + 64];
+        vsnprintf(message, sizeof(message), format, arguments);
+        format_line(line, sizeof(line), time, severity, 0, suppressed, message);
+        fputs(line, stdout);
+        return;
+    }
+
+    LogThreadRing* ring = thread_ring();
+    uint64_t head = ring->m_head.load(std::memory_order_relaxed);
+
+    if (head - ring->m_tail.load(std::memory_order_acquire) >= (uint64_t)RING_CAPACITY) {
+        ring->m_dropped.store(ring->m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    LogRecord& record = ring->m_records[head % RING_CAPACITY];
+    record.m_time = time;
+    record.m_severity = severity;
+    record.m_suppressed = suppressed;
+    vsnprintf(record.m_message, sizeof(record.m_message), format, arguments);
+
+    ring->m_head.store(head + 1, std::memory_order_release);
+}
+
+// ––––– DRAINING ––––– //
+void Logger::format_line(char* line, size_t size, uint64_t time, LogSeverity severity, int thread_id,
+                         uint32_t suppressed, const char* message) const {
+    double seconds = time > m_start_time ? (double)(time - m_start_time) / 1e9 : 0.0;
+
+    if (suppressed > 0) {
+        snprintf(line, size, "%10.6f %-7s [T%d] %s (%u similar suppressed)\n", seconds, SEVERITY_NAMES[severity], thread_id, message, suppressed);
+    } else {
+        snprintf(line, size, "%10.6f %-7s [T%d] %s\n", seconds, SEVERITY_NAMES[severity], thread_id, message);
+    }
+}
+
+void Logger::drain_loop() {
+    MEMORY_SCOPE(MEMORY_LOGGING);
+    while (m_is_running) {
+        drain();
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_wake_condition.wait_for(lock, std::chrono::milliseconds(DRAIN_INTERVAL_MS), [this] { return !m_is_running.load(); });
+    }
+}
+
+// Everything the rings hold right now, merged across threads by time
+void Logger::drain() {
+    std::lock_guard<std::mutex> drain_lock(m_drain_mutex);
+
+    std::vector<LogThreadRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(m_rings_mutex);
+        rings = m_rings;
+    }
+
+    std::vector<uint64_t> heads(rings.size());
+    m_drain_order.clear();
+    uint64_t dropped = 0;
+
+    for (size_t i = 0; i < rings.size(); i++) {
+        heads[i] = rings[i]->m_head.load(std::memory_order_acquire);
+        for (uint64_t record = rings[i]->m_tail.load(std::memory_order_relaxed); record < heads[i]; record++) {
+            m_drain_order.push_back((uint64_t)i << 32 | (record % RING_CAPACITY));
+        }
+        dropped += rings[i]->m_dropped.load(std::memory_order_relaxed);
+    }
+
+    auto record_of = [&](uint64_t entry) -> const LogRecord& { return rings[entry >> 32]->m_records[entry & 0xffffffffu]; };
+    std::stable_sort(m_drain_order.begin(), m_drain_order.end(),
+                     [&](uint64_t a, uint64_t b) { return record_of(a).m_time < record_of(b).m_time; });
+
+    char line[MESSAGE_SIZE + 64];
+    for (uint64_t entry : m_drain_order) {
+        const LogRecord& record = record_of(entry);
+        format_line(line, sizeof(line), record.m_time, record.m_severity, rings[entry >> 32]->m_thread_id, record.m_suppressed, record.m_message);
+        fputs(line, m_output);
+    }
+
+    if (dropped > m_reported_drops) {
+        fprintf(m_output, "%10s %-7s [logger] %llu messages dropped, rings full\n", "", SEVERITY_NAMES[SEVERITY_WARNING],
+                (unsigned long long)(dropped - m_reported_drops));
+        m_reported_drops = dropped;
+    }
+
+    // Hand the slots back only once they are written out
+    for (size_t i = 0; i < rings.size(); i++) rings[i]->m_tail.store(heads[i], std::memory_order_release);
+
+    if (!m_drain_order.empty()) fflush(m_output);
+}
@@ -0,0 +1,137 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum LogSeverity { SEVERITY_DEBUG, SEVERITY_INFO, SEVERITY_WARNING, SEVERITY_ERROR };
+
+// Messages below this severity are compiled out entirely, arguments and all
+#ifndef LOG_COMPILED_SEVERITY
+#define LOG_COMPILED_SEVERITY SEVERITY_DEBUG
+#endif
+
+#ifdef __GNUC__
+#define LOG_PRINTF_FORMAT(format_index, first_argument) __attribute__((format(printf, format_index, first_argument)))
+#else
+#define LOG_PRINTF_FORMAT(format_index, first_argument)
+#endif
+
+struct LogThreadRing;
+
+// Lets at most one message through per `interval` seconds; one per call site of LOG_EVERY.
+// Remembers how many it held back so the next message that gets through can say so.
+class LogRateLimit {
+private:
+    std::atomic<uint64_t> m_next_allowed{0};
+    std::atomic<uint32_t> m_suppressed{0};
+    uint64_t m_interval;
+
+public:
+    explicit LogRateLimit(float interval) : m_interval((uint64_t)(interval * 1e9f)) {}
+
+    // Whether a message may go out now; if so, `suppressed` is how many were held back before it
+    bool allow(uint32_t& suppressed);
+};
+
+// Asynchronous logger. A thread formats its message straight into its own ring of fixed-size
+// records, which only it writes and only the drain thread reads, so logging takes no lock,
+// never allocates after the thread's first message and never waits on the console or a file.
+// If a ring is full the message is dropped and counted rather than blocking the caller.
+//
+// The drain thread wakes every few milliseconds, writes whatever has arrived in time order and
+// flushes once per batch. Before start() (or after shutdown()) messages are written directly.
+class Logger {
+private:
+    mutable std::mutex m_rings_mutex;       // guards registration only, never logging
+    std::vector<LogThreadRing*> m_rings;
+
+    std::mutex m_drain_mutex;               // one consumer at a time: the drain thread or flush()
+    std::vector<uint64_t> m_drain_order;    // ring index << 32 | record index, sorted by time
+
+    std::thread m_drain_thread;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake_condition;
+    std::atomic<bool> m_is_running{false};
+
+    FILE* m_output = nullptr;
+    bool m_owns_output = false;
+    std::atomic<int> m_severity{SEVERITY_DEBUG};
+    uint64_t m_start_time = now();
+    uint64_t m_reported_drops = 0;
+
+    LogThreadRing* thread_ring();
+    void drain_loop();
+    void drain();
+    void format_line(char* line, size_t size, uint64_t time, LogSeverity severity, int thread_id,
+                     uint32_t suppressed, const char* message) const;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int MESSAGE_SIZE = 240;            // longer messages are cut short
+    static constexpr int RING_CAPACITY = 512;           // records per thread
+    static constexpr int DRAIN_INTERVAL_MS = 10;
+
+    // ————— METHODS ————— //
+    Logger() = default;
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Starts the drain thread, writing to `path` or to stdout when it is nullptr
+    bool start(const char* path = nullptr);
+    void shutdown();
+
+    // Writes out everything logged so far before returning
+    void flush();
+
+    void write(LogSeverity severity, const char* format, ...) LOG_PRINTF_FORMAT(3, 4);
+    void write_limited(LogSeverity severity, LogRateLimit& limit, const char* format, ...) LOG_PRINTF_FORMAT(4, 5);
+    void write_arguments(LogSeverity severity, uint32_t suppressed, const char* format, va_list arguments);
+
+    static uint64_t now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // ————— GETTERS ————— //
+    LogSeverity const get_severity() const { return (LogSeverity)m_severity.load(std::memory_order_relaxed); }
+    bool const is_running() const { return m_is_running.load(); }
+    uint64_t const get_dropped_count() const;
+
+    // ————— SETTERS ————— //
+    // Runtime filter on top of LOG_COMPILED_SEVERITY
+    void set_severity(LogSeverity severity) { m_severity.store(severity, std::memory_order_relaxed); }
+};
+
+extern Logger g_logger;
+
+#define LOG_AT(severity, ...) \
+    do { \
+        if constexpr ((severity) >= LOG_COMPILED_SEVERITY) { \
+            if ((severity) >= g_logger.get_severity()) g_logger.write((severity), __VA_ARGS__); \
+        } \
+    } while (0)
+
+// At most one message per `interval` seconds from this call site
+#define LOG_EVERY(severity, interval, ...) \
+    do { \
+        if constexpr ((severity) >= LOG_COMPILED_SEVERITY) { \
+            static LogRateLimit log_rate_limit((interval)); \
+            if ((severity) >= g_logger.get_severity()) g_logger.write_limited((severity), log_rate_limit, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(SEVERITY_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(SEVERITY_INFO, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(SEVERITY_WARNING, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(SEVERITY_ERROR, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,172 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "MemoryTracker.h"
+
+constinit MemoryTracker g_memory;
+
+thread_local MemoryTag t_memory_tag = MEMORY_GENERAL;
+
+// In front of every tracked block. Keeps the user pointer aligned to max_align_t.
+struct MemoryHeader {
+    uint64_t m_size;
+    uint32_t m_tag;
+    uint32_t m_offset;                      // from the start of the malloc'd block to the user pointer
+};
+
+constexpr size_t HEADER_SIZE = alignof(std::max_align_t) > sizeof(MemoryHeader) ? alignof(std::max_align_t) : sizeof(MemoryHeader);
+
+constexpr const char* TAG_NAMES[MEMORY_TAG_COUNT] = {
+    "general", "images", "textures", "collision", "shaders", "level", "snapshots",
+    "terrain", "physics", "jobs", "logging", "profiling", "diagnostics"
+};
+
+// ––––– COUNTING ––––– //
+void raise_peak(std::atomic<uint64_t>& peak, uint64_t value) {
+    uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void MemoryTracker::count_allocation(MemoryTag tag, size_t size) {
+    for (TagCounters* counters : { &m_counters[tag], &m_total }) {
+        uint64_t live = counters->m_live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        raise_peak(counters->m_peak_bytes, live);
+
+        counters->m_live_allocations.fetch_add(1, std::memory_order_relaxed);
+        counters->m_total_allocations.fetch_add(1, std::memory_order_relaxed);
+        counters->m_frame_allocations.fetch_add(1, std::memory_order_relaxed);
+        counters->m_frame_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+void MemoryTracker::count_free(MemoryTag tag, size_t size) {
+    for (TagCounters* counters : { &m_counters[tag], &m_total }) {
+        counters->m_live_bytes.fetch_sub(size, std::memory_order_relaxed);
+        counters->m_live_allocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void MemoryTracker::add_gpu_bytes(MemoryTag tag, uint64_t bytes) {
+    for (TagCounters* counters : { &m_counters[tag], &m_total }) {
+        uint64_t live = counters->m_gpu_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        raise_peak(counters->m_gpu_peak_bytes, live);
+    }
+}
+
+void MemoryTracker::remove_gpu_bytes(MemoryTag tag, uint64_t bytes) {
+    for (TagCounters* counters : { &m_counters[tag], &m_total }) counters->m_gpu_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::end_frame() {
+    for (int tag = 0; tag <= MEMORY_TAG_COUNT; tag++) {
+        TagCounters& counters = tag < MEMORY_TAG_COUNT ? m_counters[tag] : m_total;
+        m_last_frame_allocations[tag] = counters.m_frame_allocations.exchange(0, std::memory_order_relaxed);
+        m_last_frame_bytes[tag] = counters.m_frame_bytes.exchange(0, std::memory_order_relaxed);
+    }
+}
+
+MemoryTagStats MemoryTracker::stats(const TagCounters& counters, int frame_index) const {
+    MemoryTagStats stats;
+    stats.m_live_bytes = counters.m_live_bytes.load(std::memory_order_relaxed);
+    stats.m_peak_bytes = counters.m_peak_bytes.load(std::memory_order_relaxed);
+    stats.m_live_allocations = counters.m_live_allocations.load(std::memory_order_relaxed);
+    stats.m_total_allocations = counters.m_total_allocations.load(std::memory_order_relaxed);
+    stats.m_gpu_bytes = counters.m_gpu_bytes.load(std::memory_order_relaxed);
+    stats.m_gpu_peak_bytes = counters.m_gpu_peak_bytes.load(std::memory_order_relaxed);
+    stats.m_frame_allocations = m_last_frame_allocations[frame_index];
+    stats.m_frame_bytes = m_last_frame_bytes[frame_index];
+    return stats;
+}
+
+MemoryTagStats const MemoryTracker::get_stats(MemoryTag tag) const { return stats(m_counters[tag], tag); }
+
+MemoryTagStats const MemoryTracker::get_total() const { return stats(m_total, MEMORY_TAG_COUNT); }
+
+const char* MemoryTracker::tag_name(MemoryTag tag) { return tag >= 0 && tag < MEMORY_TAG_COUNT ? TAG_NAMES[tag] : "?"; }
+
+// ––––– TAGS ––––– //
+MemoryTag memory_current_tag() { return t_memory_tag; }
+
+MemoryScope::MemoryScope(MemoryTag tag) : m_previous(t_memory_tag) { t_memory_tag = tag; }
+
+MemoryScope::~MemoryScope() { t_memory_tag = m_previous; }
+
+// ––––– ALLOCATION ––––– //
+#if MEMORY_TRACKING_ENABLED
+
+MemoryHeader* header_of(void* pointer) {
+    return reinterpret_cast<MemoryHeader*>(static_cast<char*>(pointer) - sizeof(MemoryHeader));
+}
+
+// `alignment` beyond max_align_t is only ever asked for by aligned operator new
+void* allocate_aligned(size_t size, size_t alignment, MemoryTag tag) {
+    size_t padding = alignment > HEADER_SIZE ? alignment - 1 + HEADER_SIZE : HEADER_SIZE;
+    if (size > SIZE_MAX - padding) { return nullptr; }
+
+    char* block = static_cast<char*>(malloc(size + padding));
+    if (block == nullptr) { return nullptr; }
+
+    uintptr_t user = (reinterpret_cast<uintptr_t>(block) + HEADER_SIZE + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    char* pointer = reinterpret_cast<char*>(user);
+
+    MemoryHeader* header = header_of(pointer);
+    header->m_size = size;
+    header->m_tag = tag;
+    header->m_offset = (uint32_t)(pointer - block);
+
+    g_memory.count_allocation(tag, size);
+    return pointer;
+}
+
+void* memory_allocate(size_t size, MemoryTag tag) { return allocate_aligned(size, alignof(std::max_align_t), tag); }
+
+void memory_free(void* pointer) {
+    if (pointer == nullptr) { return; }
+
+    MemoryHeader* header = header_of(pointer);
+    g_memory.count_free((MemoryTag)header->m_tag, header->m_size);
+    free(static_cast<char*>(pointer) - header->m_offset);
+}
+
+void* memory_reallocate(void* pointer, size_t size, MemoryTag tag) {
+    if (pointer == nullptr) { return memory_allocate(size, tag); }
+
+    void* moved = memory_allocate(size, tag);
+    if (moved == nullptr) { return nullptr; }
+
+    size_t old_size = header_of(pointer)->m_size;
+    memcpy(moved, pointer, old_size < size ? old_size : size);
+    memory_free(pointer);
+    return moved;
+}
+
+// ––––– GLOBAL OPERATOR NEW AND DELETE ––––– //
+void* operator_new(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+
+    void* pointer = allocate_aligned(size, alignment, t_memory_tag);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(size_t size) { return operator_new(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return operator_new(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return operator_new(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return operator_new(size, (size_t)alignment); }
+
+void operator delete(void* pointer) noexcept { memory_free(pointer); }
+void operator delete[](void* pointer) noexcept { memory_free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { memory_free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { memory_free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { memory_free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { memory_free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { memory_free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { memory_free(pointer); }
+
+#else
+
+void* memory_allocate(size_t size, MemoryTag tag) { return malloc(size); }
+void* memory_reallocate(void* pointer, size_t size, MemoryTag tag) { return realloc(pointer, size); }
+void memory_free(void* pointer) { free(pointer); }
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Builds without it (-DMEMORY_TRACKING_ENABLED=0) keep the standard operator new and delete and
+// compile every MEMORY_SCOPE away
+#ifndef MEMORY_TRACKING_ENABLED
+#define MEMORY_TRACKING_ENABLED 1
+#endif
+
+// Who an allocation is charged to. CPU heap bytes and (estimated) GPU bytes are kept apart.
+enum MemoryTag {
+    MEMORY_GENERAL,                 // anything outside a MEMORY_SCOPE
+    MEMORY_IMAGES,                  // stb_image decode buffers
+    MEMORY_TEXTURES,                // GL textures
+    MEMORY_COLLISION,               // collision masks
+    MEMORY_SHADERS,
+    MEMORY_LEVEL,                   // the level arena and its entities
+    MEMORY_SNAPSHOTS,
+    MEMORY_TERRAIN,
+    MEMORY_PHYSICS,
+    MEMORY_JOBS,
+    MEMORY_LOGGING,
+    MEMORY_PROFILING,
+    MEMORY_DIAGNOSTICS,             // telemetry, input recording, frame timings
+    MEMORY_TAG_COUNT
+};
+
+struct MemoryTagStats {
+    uint64_t m_live_bytes;
+    uint64_t m_peak_bytes;
+    uint64_t m_live_allocations;
+    uint64_t m_total_allocations;
+    uint64_t m_gpu_bytes;
+    uint64_t m_gpu_peak_bytes;
+
+    // Over the last frame (between the last two end_frame() calls)
+    uint32_t m_frame_allocations;
+    uint64_t m_frame_bytes;
+};
+
+// Heap accounting. Global operator new/delete (and stb_image, through STBI_MALLOC) go through
+// memory_allocate(), which puts a small header in front of each block recording its size and the
+// tag of the MEMORY_SCOPE the allocating thread was in; freeing reads the header back, so every
+// byte is returned to the tag it was charged to whichever thread frees it.
+//
+// GPU memory cannot be seen from here: whoever creates a texture or buffer estimates its size and
+// reports it with add_gpu_bytes()/remove_gpu_bytes().
+//
+// Counters are relaxed atomics, updated from any thread; end_frame() is called by the main thread
+// once per frame and turns the running counts into per-frame ones.
+class MemoryTracker {
+private:
+    struct TagCounters {
+        std::atomic<uint64_t> m_live_bytes{0};
+        std::atomic<uint64_t> m_peak_bytes{0};
+        std::atomic<uint64_t> m_live_allocations{0};
+        std::atomic<uint64_t> m_total_allocations{0};
+        std::atomic<uint64_t> m_gpu_bytes{0};
+        std::atomic<uint64_t> m_gpu_peak_bytes{0};
+
+        std::atomic<uint32_t> m_frame_allocations{0};
+        std::atomic<uint64_t> m_frame_bytes{0};
+    };
+
+    TagCounters m_counters[MEMORY_TAG_COUNT];
+    TagCounters m_total;                    // all tags together; its peak is not the sum of theirs
+
+    // The last finished frame's counts, kept by end_frame()
+    uint32_t m_last_frame_allocations[MEMORY_TAG_COUNT + 1] = {};     // the total last
+    uint64_t m_last_frame_bytes[MEMORY_TAG_COUNT + 1] = {};
+
+    MemoryTagStats stats(const TagCounters& counters, int frame_index) const;
+
+public:
+    // ————— METHODS ————— //
+    constexpr MemoryTracker() = default;
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    void count_allocation(MemoryTag tag, size_t size);
+    void count_free(MemoryTag tag, size_t size);
+
+    void add_gpu_bytes(MemoryTag tag, uint64_t bytes);
+    void remove_gpu_bytes(MemoryTag tag, uint64_t bytes);
+
+    void end_frame();
+
+    static const char* tag_name(MemoryTag tag);
+
+    // ————— GETTERS ————— //
+    MemoryTagStats const get_stats(MemoryTag tag) const;
+    MemoryTagStats const get_total() const;
+};
+
+extern MemoryTracker g_memory;
+
+// Tagged allocation for C-style callers (STBI_MALLOC and friends); the tag is per call
+void* memory_allocate(size_t size, MemoryTag tag);
+void* memory_reallocate(void* pointer, size_t size, MemoryTag tag);
+void memory_free(void* pointer);
+
+MemoryTag memory_current_tag();
+
+// Charges what the current thread allocates during its lifetime to `tag`; MEMORY_SCOPE declares one
+class MemoryScope {
+private:
+    MemoryTag m_previous;
+
+public:
+    explicit MemoryScope(MemoryTag tag);
+    ~MemoryScope();
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+};
+
+#if MEMORY_TRACKING_ENABLED
+#define MEMORY_CONCATENATE_INNER(a, b) a##b
+#define MEMORY_CONCATENATE(a, b) MEMORY_CONCATENATE_INNER(a, b)
+#define MEMORY_SCOPE(tag) MemoryScope MEMORY_CONCATENATE(memory_scope_, __LINE__)(tag)
+#else
+#define MEMORY_SCOPE(tag) ((void)0)
+#endif
+
+#endif // MEMORYTRACKER_H
@@ -0,0 +1,231 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include "PerfCounters.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+PerfCounters g_perf;
+
+// Only the thread that opened the counters is counted
+thread_local bool t_perf_is_owner = false;
+
+constexpr const char* PHASE_NAMES[PERF_PHASE_COUNT] = { "other", "input", "physics", "collision", "render", "swap" };
+constexpr const char* COUNTER_NAMES[PERF_COUNTER_COUNT] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) m_descriptors[i] = -1;
+}
+
+PerfCounters::~PerfCounters() { close(); }
+
+const char* PerfCounters::phase_name(PerfPhase phase) { return PHASE_NAMES[phase]; }
+
+const char* PerfCounters::counter_name(PerfCounter counter) { return COUNTER_NAMES[counter]; }
+
+#ifdef __linux__
+
+struct PerfEventType {
+    uint32_t m_type;
+    uint64_t m_config;
+};
+
+// By PerfCounter
+constexpr PerfEventType EVENT_TYPES[PERF_COUNTER_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+int open_event(const PerfEventType& event, int group) {
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = event.m_type;
+    attributes.config = event.m_config;
+    attributes.disabled = group == -1;      // the whole group starts with its leader
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0);
+}
+
+bool PerfCounters::open() {
+    if (is_open()) { return true; }
+
+    m_group = open_event(EVENT_TYPES[PERF_CYCLES], -1);
+    if (m_group == -1) {
+        LOG_WARNING("Unable to open hardware counters: %s (see /proc/sys/kernel/perf_event_paranoid)", strerror(errno));
+        return false;
+    }
+
+    m_descriptors[PERF_CYCLES] = m_group;
+    m_read_order[0] = PERF_CYCLES;
+    m_open_count = 1;
+
+    for (int counter = PERF_CYCLES + 1; counter < PERF_COUNTER_COUNT; counter++) {
+        m_descriptors[counter] = open_event(EVENT_TYPES[counter], m_group);
+        if (m_descriptors[counter] == -1) {
+            LOG_WARNING("No %s counter: %s", COUNTER_NAMES[counter], strerror(errno));
+            continue;
+        }
+        m_read_order[m_open_count++] = counter;
+    }
+
+    ioctl(m_group, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_group, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    t_perf_is_owner = true;
+    m_stack[0] = PERF_OTHER;
+    m_depth = 1;
+    read(m_last);
+
+    // A minute of frames up front, at 200 bytes each
+    MEMORY_SCOPE(MEMORY_DIAGNOSTICS);
+    m_frames.reserve(60 * 60);
+    return true;
+}
+
+void PerfCounters::close() {
+    for (int counter = PERF_COUNTER_COUNT - 1; counter >= 0; counter--) {
+        if (m_descriptors[counter] != -1) ::close(m_descriptors[counter]);
+        m_descriptors[counter] = -1;
+    }
+
+    m_group = -1;
+    m_open_count = 0;
+    t_perf_is_owner = false;
+}
+
+bool PerfCounters::read(uint64_t counts[PERF_COUNTER_COUNT]) {
+    uint64_t buffer[3 + PERF_COUNTER_COUNT];    // count, time enabled, time running, values
+    if (::read(m_group, buffer, sizeof(buffer)) < (ssize_t)(3 + m_open_count) * (ssize_t)sizeof(uint64_t)) { return false; }
+
+    uint64_t enabled = buffer[1],
+             running = buffer[2];
+    if (running == 0) { return false; }     // the group has not been on the PMU yet
+    if (running < enabled) m_was_multiplexed = true;
+
+    for (int i = 0; i < m_open_count; i++) {
+        uint64_t value = buffer[3 + i];
+        counts[m_read_order[i]] = running < enabled ? (uint64_t)((double)value * enabled / running) : value;
+    }
+    return true;
+}
+
+#else
+
+bool PerfCounters::open() {
+    LOG_WARNING("Hardware counters are only supported on Linux");
+    return false;
+}
+
+void PerfCounters::close() {}
+
+bool PerfCounters::read(uint64_t counts[PERF_COUNTER_COUNT]) { return false; }
+
+#endif
+
+// Whatever ran since the last phase change belongs to the phase on top of the stack
+void PerfCounters::charge() {
+    uint64_t counts[PERF_COUNTER_COUNT] = {};
+    if (!read(counts)) { return; }
+
+    PerfPhase phase = m_stack[(m_depth < MAX_DEPTH ? m_depth : MAX_DEPTH) - 1];
+    for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++) {
+        // Scaled counts can step back a little when the scaling changes; never charge a wrap
+        if (counts[counter] > m_last[counter]) m_frame.m_counts[phase][counter] += counts[counter] - m_last[counter];
+        m_last[counter] = counts[counter];
+    }
+}
+
+void PerfCounters::begin(PerfPhase phase) {
+    charge();
+    if (m_depth < MAX_DEPTH) m_stack[m_depth] = phase;
+    m_depth++;
+}
+
+void PerfCounters::end() {
+    charge();
+    if (m_depth > 1) m_depth--;
+}
+
+void PerfCounters::end_frame() {
+    if (!is_open()) { return; }
+
+    charge();
+    MEMORY_SCOPE(MEMORY_DIAGNOSTICS);
+    m_frames.push_back(m_frame);
+    m_frame = PerfFrame();
+}
+
+PerfFrame PerfCounters::total(int first_frame) const {
+    PerfFrame total = {};
+    for (int frame = first_frame; frame < (int)m_frames.size(); frame++) {
+        for (int phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+            for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++) total.m_counts[phase][counter] += m_frames[frame].m_counts[phase][counter];
+        }
+    }
+    return total;
+}
+
+// Per phase: the mean per frame, instructions per cycle and misses per thousand instructions
+void PerfCounters::log_summary(int first_frame) const {
+    int frame_count = (int)m_frames.size() - first_frame;
+    if (!is_open() || frame_count <= 0) { return; }
+
+    PerfFrame sum = total(first_frame);
+    LOG_INFO("Perf: %d frames%s", frame_count, m_was_multiplexed ? ", counters multiplexed (scaled)" : "");
+    LOG_INFO("Perf %-10s %12s %12s %6s %10s %10s %10s", "phase", "cycles/f", "instr/f", "ipc", "l1d_mpki", "llc_mpki", "br_mpki");
+
+    for (int phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+        const uint64_t* counts = sum.m_counts[phase];
+        if (counts[PERF_CYCLES] == 0 && counts[PERF_INSTRUCTIONS] == 0) continue;     // did not run (headless render)
+
+        double instructions = (double)counts[PERF_INSTRUCTIONS];
+        auto per_kilo_instruction = [instructions](uint64_t misses) { return instructions > 0.0 ? 1000.0 * misses / instructions : 0.0; };
+
+        LOG_INFO("Perf %-10s %12.0f %12.0f %6.2f %10.3f %10.3f %10.3f", PHASE_NAMES[phase],
+                 (double)counts[PERF_CYCLES] / frame_count, instructions / frame_count,
+                 counts[PERF_CYCLES] > 0 ? instructions / counts[PERF_CYCLES] : 0.0,
+                 per_kilo_instruction(counts[PERF_L1D_MISSES]), per_kilo_instruction(counts[PERF_LLC_MISSES]),
+                 per_kilo_instruction(counts[PERF_BRANCH_MISSES]));
+    }
+}
+
+// Counters that did not open are left empty rather than written as 0
+bool PerfCounters::write_csv(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) { return false; }
+
+    fprintf(file, "frame,phase");
+    for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++) fprintf(file, ",%s", COUNTER_NAMES[counter]);
+    fprintf(file, "\n");
+
+    for (int frame = 0; frame < (int)m_frames.size(); frame++) {
+        for (int phase = 0; phase < PERF_PHASE_COUNT; phase++) {
+            fprintf(file, "%d,%s", frame, PHASE_NAMES[phase]);
+            for (int counter = 0; counter < PERF_COUNTER_COUNT; counter++) {
+                if (has_counter((PerfCounter)counter)) fprintf(file, ",%llu", (unsigned long long)m_frames[frame].m_counts[phase][counter]);
+                else fprintf(file, ",");
+            }
+            fprintf(file, "\n");
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+PerfScope::PerfScope(PerfPhase phase) : m_is_counted(t_perf_is_owner) {
+    if (m_is_counted) g_perf.begin(phase);
+}
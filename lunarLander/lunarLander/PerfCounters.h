@@ -0,0 +1,110 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+#include <vector>
+
+// Where the counts go. Scopes nest and a count belongs to the innermost one only, so collision
+// is not also counted as physics; anything outside every scope is PERF_OTHER.
+enum PerfPhase {
+    PERF_OTHER,
+    PERF_INPUT,
+    PERF_PHYSICS,
+    PERF_COLLISION,                 // sweeps and overlap resolution inside the physics step
+    PERF_RENDER,                    // building and submitting the draw calls
+    PERF_SWAP,
+    PERF_PHASE_COUNT
+};
+
+enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,                // L1 data cache read misses
+    PERF_LLC_MISSES,                // last-level cache misses
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+};
+
+struct PerfFrame {
+    uint64_t m_counts[PERF_PHASE_COUNT][PERF_COUNTER_COUNT];
+};
+
+// Hardware performance counters (Linux perf_event_open) on the thread that opens them, charged
+// to engine phases through PERF_SCOPE. Counting is user space only, which is what an unprivileged
+// process gets with the default perf_event_paranoid of 2.
+//
+// The counters are one group, scheduled onto the PMU together and read with a single read() at
+// every phase change; a counter the CPU does not have (common under virtual machines) is left
+// out and reads 0. If the kernel has to multiplex the group with other users the counts are
+// scaled up by enabled / running time, as perf stat does.
+//
+// Other threads are not counted, and their PERF_SCOPEs do nothing: physics handed to job workers
+// shows up as the main thread waiting in it, not as the work itself.
+class PerfCounters {
+private:
+    static constexpr int MAX_DEPTH = 16;
+
+    int m_descriptors[PERF_COUNTER_COUNT];  // -1 for counters that did not open
+    int m_group = -1;                       // the leader's descriptor
+    int m_read_order[PERF_COUNTER_COUNT];   // which counter each value read from the group is
+    int m_open_count = 0;
+
+    uint64_t m_last[PERF_COUNTER_COUNT] = {};
+    PerfPhase m_stack[MAX_DEPTH];
+    int m_depth = 0;
+
+    PerfFrame m_frame = {};
+    std::vector<PerfFrame> m_frames;
+    bool m_was_multiplexed = false;
+
+    bool read(uint64_t counts[PERF_COUNTER_COUNT]);
+    void charge();
+
+public:
+    // ————— METHODS ————— //
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool open();                            // on the thread to be counted; logs why if it cannot
+    void close();
+
+    void begin(PerfPhase phase);
+    void end();
+    void end_frame();
+
+    PerfFrame total(int first_frame = 0) const;
+    void log_summary(int first_frame = 0) const;
+    bool write_csv(const char* path) const;     // one row per frame and phase
+
+    static const char* phase_name(PerfPhase phase);
+    static const char* counter_name(PerfCounter counter);
+
+    // ————— GETTERS ————— //
+    bool const is_open() const { return m_group != -1; }
+    bool const has_counter(PerfCounter counter) const { return m_descriptors[counter] != -1; }
+    int const get_frame_count() const { return (int)m_frames.size(); }
+};
+
+extern PerfCounters g_perf;
+
+// Charges what runs during its lifetime to `phase`; PERF_SCOPE declares one
+class PerfScope {
+private:
+    bool m_is_counted;
+
+public:
+    explicit PerfScope(PerfPhase phase);
+    ~PerfScope() { if (m_is_counted) g_perf.end(); }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+};
+
+#define PERF_CONCATENATE_INNER(a, b) a##b
+#define PERF_CONCATENATE(a, b) PERF_CONCATENATE_INNER(a, b)
+#define PERF_SCOPE(phase) PerfScope PERF_CONCATENATE(perf_scope_, __LINE__)(phase)
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,129 @@
+#include <cmath>
+#include "PhysicsWorld.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+#include "PerfCounters.h"
+
+void PhysicsWorld::clear() {
+    m_bodies.clear();
+    m_body_contacts.clear();
+    m_body_substeps.clear();
+    m_colliders = nullptr;
+    m_collider_count = 0;
+    m_terrain = nullptr;
+    m_gravity = nullptr;
+    m_query.build(nullptr, 0);
+    m_awake_count = 0;
+    m_substep_count = 0;
+}
+
+void PhysicsWorld::add_body(Entity* body) {
+    body->add_physics();
+    m_bodies.push_back(body);
+    m_body_contacts.emplace_back();
+    m_body_substeps.push_back(0);
+}
+
+void PhysicsWorld::set_colliders(Entity* colliders, int collider_count) {
+    m_colliders = colliders;
+    m_collider_count = collider_count;
+    m_query.build(m_colliders, m_collider_count, m_terrain);
+}
+
+void PhysicsWorld::set_terrain(const Terrain* terrain) {
+    m_terrain = terrain;
+    m_query.build(m_colliders, m_collider_count, m_terrain);
+}
+
+// A body that has been at rest for SLEEP_STEPS steps sleeps until input, a force or a new
+// velocity wakes it
+void PhysicsWorld::update_sleep() {
+    m_awake_count = 0;
+
+    for (Entity* body : m_bodies) {
+        if (body->is_sleeping()) continue;
+
+        if (body->is_active() && body->get_physics()->m_rest_steps >= SLEEP_STEPS) body->put_to_sleep();
+        else m_awake_count++;
+    }
+}
+
+// Gap between the body's box and the nearest collider box or the ground below it;
+// negative when already overlapping. Nothing further than `reach` away matters.
+float const PhysicsWorld::distance_to_contact(const Entity* body, float reach) const {
+    glm::vec3 centre = body->get_position(),
+              half_extents(body->get_width() / 2.0f, body->get_height() / 2.0f, 0.0f);
+    
+    float distance = INFINITY;
+    m_query.nearest(centre, half_extents, reach, &distance);
+    return fmin(distance, m_query.ground_clearance(centre, half_extents));
+}
+
+int const PhysicsWorld::choose_substeps(const Entity* body, float delta_time) const {
+    float travel = glm::length(body->get_velocity()) * delta_time;
+    float size = fmin(body->get_width(), body->get_height());
+    
+    int substeps = 1;
+    if (size > 0.0f) substeps = (int)ceilf(travel / (size * MAX_TRAVEL_FRACTION));
+    
+    // Within reach of something this step: slow down to get the contact right
+    if (substeps < CONTACT_SUBSTEPS && distance_to_contact(body, CONTACT_DISTANCE + travel) < CONTACT_DISTANCE + travel) substeps = CONTACT_SUBSTEPS;
+    
+    if (substeps < 1) substeps = 1;
+    if (substeps > MAX_SUBSTEPS) substeps = MAX_SUBSTEPS;
+    return substeps;
+}
+
+void PhysicsWorld::step(float delta_time, ContactBuffer& contacts) {
+    PROFILE_SCOPE("PhysicsWorld::step");
+    MEMORY_SCOPE(MEMORY_PHYSICS);
+    int body_count = (int)m_bodies.size();
+
+    if (m_gravity != nullptr) {
+        PROFILE_SCOPE("GravityField::build");
+        m_gravity->build(m_job_system);
+    }
+    
+    auto step_bodies = [this, delta_time](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            PROFILE_SCOPE("Entity::update");
+            m_body_contacts[i].clear();
+            
+            // Sleeping bodies rest on something that already holds them against the pull
+            Entity* body = m_bodies[i];
+            if (m_gravity != nullptr && body->is_active() && !body->is_sleeping()) {
+                body->get_physics()->m_force += m_gravity->acceleration_at(body->get_position(), body);
+            }
+            
+            m_body_substeps[i] = 0;
+            if (!body->begin_update(delta_time, m_body_contacts[i])) continue;
+            
+            int substeps = choose_substeps(body, delta_time);
+            float substep_time = delta_time / substeps;
+            
+            for (int substep = 0; substep < substeps; substep++) {
+                PERF_SCOPE(PERF_COLLISION);
+                body->integrate(substep_time, m_colliders, m_collider_count, m_body_contacts[i]);
+                if (m_terrain != nullptr) m_terrain->collide(body, m_body_contacts[i]);
+            }
+            
+            body->end_update();
+            m_body_substeps[i] = substeps;
+        }
+    };
+
+    if (m_job_system != nullptr && body_count >= PARALLEL_BODY_COUNT) {
+        m_job_system->parallel_for(body_count, PARALLEL_BODY_COUNT / 4, step_bodies);
+    } else {
+        step_bodies(0, body_count);
+    }
+
+    m_substep_count = 0;
+    for (int i = 0; i < body_count; i++) {
+        contacts.append(m_body_contacts[i]);
+        m_substep_count += m_body_substeps[i];
+    }
+
+    update_sleep();
+}
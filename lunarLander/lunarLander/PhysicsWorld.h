@@ -0,0 +1,74 @@
+#ifndef PHYSICSWORLD_H
+#define PHYSICSWORLD_H
+
+#include <vector>
+#include "Entity.h"
+#include "ContactEvent.h"
+#include "Terrain.h"
+#include "GravityField.h"
+#include "SpatialQuery.h"
+
+class JobSystem;
+
+// Steps every dynamic body of a level against the level's static colliders and terrain, pulled
+// by the level's gravity field if it has one.
+// Static entities never enter the world. Bodies only collide with the static colliders and the
+// terrain, never with each other, so each one sleeps on its own: after SLEEP_STEPS steps at rest
+// it costs nothing until a force, input or a new velocity wakes it.
+class PhysicsWorld {
+private:
+    std::vector<Entity*> m_bodies;
+    std::vector<ContactBuffer> m_body_contacts;     // one per body so bodies can step in parallel
+    std::vector<int> m_body_substeps;               // what each body took in the last step
+
+    Entity* m_colliders = nullptr;
+    int m_collider_count = 0;
+    const Terrain* m_terrain = nullptr;
+    GravityField* m_gravity = nullptr;              // rebuilt at the start of every step
+    SpatialQuery m_query;                           // colliders and terrain, rebuilt when either is set
+
+    JobSystem* m_job_system = nullptr;
+
+    int m_awake_count = 0;
+    int m_substep_count = 0;
+
+    void update_sleep();
+    float const distance_to_contact(const Entity* body, float reach) const;
+    int const choose_substeps(const Entity* body, float delta_time) const;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int SLEEP_STEPS = 30;          // half a second of rest at 60 Hz
+    static constexpr int PARALLEL_BODY_COUNT = 64;  // below this, stepping on one thread is cheaper
+    
+    // Adaptive substepping: a body in open space that moves less than MAX_TRAVEL_FRACTION of its
+    // size per step integrates once; closer than CONTACT_DISTANCE to something, or faster, it
+    // splits the step. The world itself still advances by exactly the delta time it was given.
+    static constexpr int MAX_SUBSTEPS = 8;
+    static constexpr int CONTACT_SUBSTEPS = 2;
+    static constexpr float MAX_TRAVEL_FRACTION = 0.25f;
+    static constexpr float CONTACT_DISTANCE = 0.1f;
+
+    // ————— METHODS ————— //
+    void clear();
+    void add_body(Entity* body);
+    void set_colliders(Entity* colliders, int collider_count);
+    void set_terrain(const Terrain* terrain);
+    void set_gravity(GravityField* gravity) { m_gravity = gravity; }
+    void set_job_system(JobSystem* job_system) { m_job_system = job_system; }
+
+    void step(float delta_time, ContactBuffer& contacts);
+
+    // ————— GETTERS ————— //
+    int const get_body_count() const { return (int)m_bodies.size(); }
+    int const get_awake_count() const { return m_awake_count; }
+    int const get_sleeping_count() const { return (int)m_bodies.size() - m_awake_count; }
+    int const get_substep_count() const { return m_substep_count; }   // summed over bodies, last step
+    Entity* const get_colliders() const { return m_colliders; }
+    int const get_collider_count() const { return m_collider_count; }
+    const Terrain* const get_terrain() const { return m_terrain; }
+    GravityField* const get_gravity() const { return m_gravity; }
+    const SpatialQuery& get_query() const { return m_query; }
+};
+
+#endif // PHYSICSWORLD_H
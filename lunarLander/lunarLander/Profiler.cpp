@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "Profiler.h"
+#include "MemoryTracker.h"
+
+Profiler g_profiler;
+
+struct ProfileThreadBuffer {
+    std::unique_ptr<ProfileZone[]> m_zones;    // allocated on the first zone, so naming a thread costs nothing
+    uint64_t m_capacity;
+    std::atomic<uint64_t> m_written{0};     // zones recorded so far; in ring mode the slot is m_written % m_capacity
+    std::atomic<uint64_t> m_dropped{0};
+    int m_thread_id = 0;
+    char m_name[Profiler::MAX_THREAD_NAME] = {};
+
+    explicit ProfileThreadBuffer(int capacity) : m_capacity((uint64_t)capacity) {}
+};
+
+// The buffer the current thread records into, and for which profiler
+thread_local ProfileThreadBuffer* t_profile_buffer = nullptr;
+thread_local const Profiler* t_profile_owner = nullptr;
+
+Profiler::~Profiler() {
+    for (ProfileThreadBuffer* buffer : m_buffers) delete buffer;
+    m_buffers.clear();
+}
+
+ProfileThreadBuffer* Profiler::thread_buffer() {
+    if (t_profile_owner == this) { return t_profile_buffer; }
+    MEMORY_SCOPE(MEMORY_PROFILING);
+
+    ProfileThreadBuffer* buffer = new ProfileThreadBuffer(std::max(m_zones_per_thread, 1));
+    {
+        std::lock_guard<std::mutex> lock(m_buffers_mutex);
+        buffer->m_thread_id = (int)m_buffers.size() + 1;
+        snprintf(buffer->m_name, sizeof(buffer->m_name), "Thread %d", buffer->m_thread_id);
+        m_buffers.push_back(buffer);
+    }
+
+    t_profile_owner = this;
+    t_profile_buffer = buffer;
+    return buffer;
+}
+
+void Profiler::start() {
+    m_is_ring = false;
+    m_is_recording.store(true, std::memory_order_release);
+}
+
+void Profiler::start_ring(float seconds) {
+    m_is_ring = true;
+    m_ring_nanoseconds = (uint64_t)(seconds * 1e9);
+    m_is_recording.store(true, std::memory_order_release);
+}
+
+void Profiler::stop() {
+    m_is_recording.store(false, std::memory_order_release);
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(m_buffers_mutex);
+    for (ProfileThreadBuffer* buffer : m_buffers) {
+        buffer->m_written.store(0, std::memory_order_relaxed);
+        buffer->m_dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Only the owning thread writes to its buffer, so a plain store publishes the zone
+void Profiler::record(const char* name, uint64_t start, uint64_t end) {
+    ProfileThreadBuffer* buffer = thread_buffer();
+    uint64_t written = buffer->m_written.load(std::memory_order_relaxed);
+
+    if (!m_is_ring && written >= buffer->m_capacity) {
+        buffer->m_dropped.store(buffer->m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (buffer->m_zones == nullptr) {
+        MEMORY_SCOPE(MEMORY_PROFILING);
+        buffer->m_zones.reset(new ProfileZone[buffer->m_capacity]);
+    }
+    buffer->m_zones[written % buffer->m_capacity] = ProfileZone { name, start, end };
+    buffer->m_written.store(written + 1, std::memory_order_release);
+}
+
+void Profiler::set_thread_name(const char* name) {
+    ProfileThreadBuffer* buffer = thread_buffer();
+
+    std::lock_guard<std::mutex> lock(m_buffers_mutex);
+    snprintf(buffer->m_name, sizeof(buffer->m_name), "%s", name);
+}
+
+uint64_t const Profiler::get_zone_count() const {
+    std::lock_guard<std::mutex> lock(m_buffers_mutex);
+    uint64_t count = 0;
+    for (const ProfileThreadBuffer* buffer : m_buffers) {
+        count += std::min(buffer->m_written.load(std::memory_order_acquire), buffer->m_capacity);
+    }
+    return count;
+}
+
+uint64_t const Profiler::get_dropped_count() const {
+    std::lock_guard<std::mutex> lock(m_buffers_mutex);
+    uint64_t count = 0;
+    for (const ProfileThreadBuffer* buffer : m_buffers) count += buffer->m_dropped.load(std::memory_order_relaxed);
+    return count;
+}
+
+// ––––– CHROME TRACE ––––– //
+void write_json_string(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* character = text; *character != '\0'; character++) {
+        if (*character == '"' || *character == '\\') fputc('\\', file);
+        if ((unsigned char)*character >= 0x20) fputc(*character, file);
+    }
+    fputc('"', file);
+}
+
+bool Profiler::write_chrome_trace(const char* path) const {
+    MEMORY_SCOPE(MEMORY_PROFILING);
+    struct ThreadZones {
+        int m_thread_id;
+        char m_name[MAX_THREAD_NAME];
+        std::vector<ProfileZone> m_zones;
+    };
+    std::vector<ThreadZones> threads;
+
+    // ––––– COPY OUT ––––– //
+    // Threads may keep recording meanwhile. In ring mode that can overwrite the oldest slots as
+    // they are copied, so anything the writer could have lapped is thrown away afterwards.
+    {
+        std::lock_guard<std::mutex> lock(m_buffers_mutex);
+
+        for (const ProfileThreadBuffer* buffer : m_buffers) {
+            ThreadZones thread;
+            thread.m_thread_id = buffer->m_thread_id;
+            memcpy(thread.m_name, buffer->m_name, sizeof(thread.m_name));
+
+            uint64_t written = buffer->m_written.load(std::memory_order_acquire);
+            uint64_t first = written > buffer->m_capacity ? written - buffer->m_capacity : 0;
+            for (uint64_t i = first; i < written; i++) thread.m_zones.push_back(buffer->m_zones[i % buffer->m_capacity]);
+
+            uint64_t written_after = buffer->m_written.load(std::memory_order_acquire);
+            uint64_t lapped = written_after > buffer->m_capacity ? written_after - buffer->m_capacity : 0;
+            if (lapped > first) {
+                thread.m_zones.erase(thread.m_zones.begin(), thread.m_zones.begin() + (std::ptrdiff_t)std::min(lapped - first, written - first));
+            }
+
+            threads.push_back(std::move(thread));
+        }
+    }
+
+    // ––––– TIME WINDOW ––––– //
+    uint64_t latest = 0;
+    for (const ThreadZones& thread : threads) {
+        for (const ProfileZone& zone : thread.m_zones) latest = std::max(latest, zone.m_end);
+    }
+
+    uint64_t cutoff = m_is_ring && latest > m_ring_nanoseconds ? latest - m_ring_nanoseconds : 0;
+    uint64_t origin = UINT64_MAX;
+    for (const ThreadZones& thread : threads) {
+        for (const ProfileZone& zone : thread.m_zones) {
+            if (zone.m_end >= cutoff) origin = std::min(origin, zone.m_start);
+        }
+    }
+    if (origin == UINT64_MAX) origin = 0;
+
+    // ––––– WRITE ––––– //
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) { return false; }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Lunar Lander\"}}");
+
+    for (const ThreadZones& thread : threads) {
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", thread.m_thread_id);
+        write_json_string(file, thread.m_name);
+        fprintf(file, "}}");
+
+        // Trace timestamps are in microseconds; three decimals keep the nanoseconds
+        for (const ProfileZone& zone : thread.m_zones) {
+            if (zone.m_end < cutoff) continue;
+
+            fprintf(file, ",\n{\"name\":");
+            write_json_string(file, zone.m_name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", thread.m_thread_id,
+                    (double)(zone.m_start - origin) / 1000.0, (double)(zone.m_end - zone.m_start) / 1000.0);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
@@ -0,0 +1,108 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Builds without it (-DPROFILING_ENABLED=0) compile every PROFILE_* macro away to nothing
+#ifndef PROFILING_ENABLED
+#define PROFILING_ENABLED 1
+#endif
+
+struct ProfileZone {
+    const char* m_name;                 // must outlive the profiler: a string literal or __func__
+    uint64_t m_start, m_end;            // nanoseconds on the steady clock
+};
+
+struct ProfileThreadBuffer;
+
+// Instrumentation profiler: PROFILE_SCOPE("name") times the enclosing scope and files it under the
+// thread it ran on. Each thread records into its own fixed buffer that only it writes to, so
+// recording takes no lock and never allocates; the buffer is registered on the thread's first zone.
+//
+// In linear mode zones past a buffer's capacity are dropped (and counted). In ring mode a buffer
+// wraps around and the trace keeps just the last `seconds`, so it can be left running and dumped
+// right after something interesting happened.
+//
+// write_chrome_trace() exports the Trace Event Format that ui.perfetto.dev and chrome://tracing load.
+class Profiler {
+private:
+    mutable std::mutex m_buffers_mutex;     // guards registration only, never recording
+    std::vector<ProfileThreadBuffer*> m_buffers;
+
+    std::atomic<bool> m_is_recording{false};
+    bool m_is_ring = false;
+    uint64_t m_ring_nanoseconds = 0;
+    int m_zones_per_thread = DEFAULT_ZONES_PER_THREAD;
+
+    ProfileThreadBuffer* thread_buffer();
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int DEFAULT_ZONES_PER_THREAD = 1 << 16;
+    static constexpr int MAX_THREAD_NAME = 32;
+
+    // ————— METHODS ————— //
+    Profiler() = default;
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void start();                       // keep everything until the buffers fill up
+    void start_ring(float seconds);     // keep only the last `seconds`
+    void stop();
+
+    // Forgets every zone; only while no thread is inside a zone
+    void clear();
+
+    void record(const char* name, uint64_t start, uint64_t end);
+    void set_thread_name(const char* name);
+
+    bool write_chrome_trace(const char* path) const;
+
+    static uint64_t now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // ————— GETTERS ————— //
+    bool const is_recording() const { return m_is_recording.load(std::memory_order_relaxed); }
+    bool const is_ring() const { return m_is_ring; }
+    uint64_t const get_zone_count() const;
+    uint64_t const get_dropped_count() const;
+
+    // ————— SETTERS ————— //
+    // Applies to threads that have not recorded yet
+    void set_zones_per_thread(int zones_per_thread) { m_zones_per_thread = zones_per_thread; }
+};
+
+extern Profiler g_profiler;
+
+// Times its own lifetime; PROFILE_SCOPE declares one
+class ProfileScope {
+private:
+    const char* m_name;
+    uint64_t m_start;
+
+public:
+    explicit ProfileScope(const char* name) : m_name(name), m_start(g_profiler.is_recording() ? Profiler::now() : 0) {}
+    ~ProfileScope() { if (m_start != 0) g_profiler.record(m_name, m_start, Profiler::now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#if PROFILING_ENABLED
+#define PROFILE_CONCATENATE_INNER(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCATENATE(profile_scope_, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
+
+#endif // PROFILER_H
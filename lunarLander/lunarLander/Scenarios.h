@@ -0,0 +1,83 @@
+#ifndef SCENARIOS_H
+#define SCENARIOS_H
+
+#include "BatchSimulation.h"
+
+// ————— SCRIPTED SCENARIOS ————— //
+// Input timelines for the frame-time harness (main.cpp --scenario). Each one plays the real game
+// from the start of the level for a fixed number of frames, holding the given BatchAction keys
+// over frame ranges, and must end in the expected outcome. With the virtual clock every frame is
+// exactly one step, so the same script always flies the same path. Any change to the level or the
+// physics can move that path: run --scenario all again (with --record to keep the flight for
+// --replay) and retune the scripts that no longer end as expected.
+struct ScriptedInput {
+    int m_first_frame;
+    int m_frame_count;
+    uint8_t m_actions;                      // BatchAction bits held for those frames
+};
+
+struct Scenario {
+    const char* m_name;
+    const ScriptedInput* m_inputs;
+    int m_input_count;
+    int m_frame_count;
+    BatchOutcome m_expected_outcome;
+};
+
+// Short taps either way while drifting down, stopping well before the middle shroom (about
+// 0.2 above it; falling straight down reaches it on tick 234)
+constexpr ScriptedInput HOVER_INPUTS[] = {
+    {  20, 4, ACTION_LEFT  },
+    {  60, 8, ACTION_RIGHT },
+    { 100, 8, ACTION_LEFT  },
+    { 140, 8, ACTION_RIGHT },
+};
+
+// Accelerate towards the right-hand pc, then let the braking bring it to a stop above it
+constexpr ScriptedInput LAND_ON_PC_INPUTS[] = {
+    { 0, 48, ACTION_RIGHT },
+};
+
+// Accelerate towards the left-hand pad, brake to a stop above it and settle onto it at the
+// level's own descent speed
+constexpr ScriptedInput LAND_ON_PAD_INPUTS[] = {
+    { 0, 70, ACTION_LEFT },
+};
+
+// Nothing pressed: straight down onto the middle shroom
+constexpr ScriptedInput CRASH_INTO_SHROOM_INPUTS[] = {
+    { 0, 0, ACTION_NONE },
+};
+
+// Burn everything in place, swinging left and right
+constexpr ScriptedInput OUT_OF_FUEL_INPUTS[] = {
+    {  0, 10, ACTION_LEFT  },
+    { 10, 20, ACTION_RIGHT },
+    { 30, 20, ACTION_LEFT  },
+    { 50, 20, ACTION_RIGHT },
+    { 70, 10, ACTION_LEFT  },
+};
+
+constexpr int SCENARIO_COUNT = 5;
+
+constexpr Scenario SCENARIOS[SCENARIO_COUNT] = {
+    { "hover",             HOVER_INPUTS,             4, 180, OUTCOME_RUNNING     },
+    { "land_on_pc",        LAND_ON_PC_INPUTS,        1, 720, OUTCOME_WON         },
+    { "land_on_pad",       LAND_ON_PAD_INPUTS,       1, 900, OUTCOME_WON         },
+    { "crash_into_shroom", CRASH_INTO_SHROOM_INPUTS, 1, 360, OUTCOME_LOST        },
+    { "out_of_fuel",       OUT_OF_FUEL_INPUTS,       5, 120, OUTCOME_OUT_OF_FUEL },
+};
+
+// ————— FRAME BUDGETS ————— //
+// A scenario fails when any of these is exceeded (after --budget-scale). The first frames compile
+// shaders and upload textures in the driver, so they are played but not timed.
+constexpr int SCENARIO_WARM_UP_FRAMES = 10;
+
+constexpr float CPU_P50_BUDGET_MS = 4.0f,
+                CPU_P99_BUDGET_MS = 8.0f,
+                CPU_MAX_BUDGET_MS = 33.3f,
+                GPU_P50_BUDGET_MS = 4.0f,
+                GPU_P99_BUDGET_MS = 8.0f,
+                GPU_MAX_BUDGET_MS = 33.3f;
+
+#endif // SCENARIOS_H
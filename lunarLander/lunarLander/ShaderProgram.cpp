@@ -1,8 +1,10 @@
 #define GL_SILENCE_DEPRECATION
 
 #include "ShaderProgram.h"
+#include "MemoryTracker.h"
 
 void ShaderProgram::load(const char *vertex_shader_file, const char *fragment_shader_file) {
+    MEMORY_SCOPE(MEMORY_SHADERS);
     
     // create the vertex shader
     m_vertex_shader = load_shader_from_file(vertex_shader_file, GL_VERTEX_SHADER);
@@ -32,6 +32,8 @@ private:
     GLuint m_vertex_shader;
     GLuint m_fragment_shader;
     
+    int m_draw_call_count = 0;
+    
 public:
 
     void load(const char *vertex_shader_file, const char *fragment_shader_file);
@@ -41,9 +43,14 @@ public:
     void set_view_matrix(const glm::mat4 &matrix);
     void set_colour(float red, float green, float blue, float alpha);
     
+    // Whoever issues a draw with this program counts it here, for frame statistics
+    void count_draw_call()        { m_draw_call_count++;    };
+    void reset_draw_call_count()  { m_draw_call_count = 0;  };
+    
     GLuint const get_program_id()               const { return m_program_id;          };
     GLuint const get_position_attribute()       const { return m_position_attribute;  };
     GLuint const get_tex_coordinate_attribute() const { return m_tex_coord_attribute; };
+    int const get_draw_call_count()             const { return m_draw_call_count;     };
     
     void set_program_id(GLuint program_id)                         { m_program_id = program_id;                   };
 };
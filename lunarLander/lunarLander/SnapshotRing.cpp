@@ -0,0 +1,47 @@
+#include "SnapshotRing.h"
+#include "MemoryTracker.h"
+
+void SnapshotRing::prepare(const LevelArena& arena, int capacity) {
+    MEMORY_SCOPE(MEMORY_SNAPSHOTS);
+    m_slot_size = arena.get_snapshot_size();
+    m_capacity = capacity;
+    m_generation = arena.get_reset_count();
+    m_newest = -1;
+    m_count = 0;
+
+    // Reloading the same level asks for the same sizes, so this only allocates the first time
+    m_slots.resize(m_slot_size * capacity);
+    m_initial.resize(m_slot_size);
+    arena.save(m_initial.data());
+}
+
+bool SnapshotRing::push(const LevelArena& arena) {
+    if (m_capacity == 0 || !is_current(arena) || arena.get_snapshot_size() != m_slot_size) { return false; }
+
+    m_newest = (m_newest + 1) % m_capacity;
+    if (m_count < m_capacity) m_count++;
+
+    arena.save(&m_slots[m_newest * m_slot_size]);
+    return true;
+}
+
+bool SnapshotRing::rewind(LevelArena& arena, int ticks) {
+    if (m_count == 0 || !is_current(arena)) { return false; }
+    if (ticks > m_count - 1) ticks = m_count - 1;
+
+    m_newest = (m_newest - ticks + m_capacity) % m_capacity;
+    m_count -= ticks;
+
+    arena.restore(&m_slots[m_newest * m_slot_size]);
+    return true;
+}
+
+bool SnapshotRing::restart(LevelArena& arena) {
+    if (!is_current(arena)) { return false; }
+
+    m_newest = -1;
+    m_count = 0;
+
+    arena.restore(m_initial.data());
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef SNAPSHOTRING_H
+#define SNAPSHOTRING_H
+
+#include <vector>
+#include "LevelArena.h"
+
+// The last few seconds of a level, one copy of its arena per tick, plus the state it started in.
+// Memory is sized once per level in prepare(); after that taking and restoring snapshots is
+// a memcpy and never allocates or reloads assets.
+//
+// Rewinding drops every snapshot newer than the one restored, so playing on from there branches
+// off a new timeline ("what if I had thrusted left instead?") while the older ticks stay put.
+class SnapshotRing {
+private:
+    std::vector<char> m_slots;              // m_capacity slots of m_slot_size bytes
+    std::vector<char> m_initial;            // the level as load_level() left it
+    size_t m_slot_size = 0;
+
+    int m_capacity = 0;
+    int m_newest = -1;                      // slot of the latest snapshot
+    int m_count = 0;
+    int m_generation = -1;                  // arena reset count the snapshots belong to
+
+    bool const is_current(const LevelArena& arena) const { return arena.get_reset_count() == m_generation; }
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int DEFAULT_CAPACITY = 600;     // ten seconds at 60 Hz
+
+    // ————— METHODS ————— //
+    // Call once the level is built; forgets the previous level's snapshots
+    void prepare(const LevelArena& arena, int capacity = DEFAULT_CAPACITY);
+
+    bool push(const LevelArena& arena);
+    bool rewind(LevelArena& arena, int ticks);      // back to `ticks` snapshots before the latest
+    bool restart(LevelArena& arena);                // back to the start of the level
+
+    // ————— GETTERS ————— //
+    int const get_count() const { return m_count; }
+    int const get_capacity() const { return m_capacity; }
+    size_t const get_slot_size() const { return m_slot_size; }
+};
+
+#endif // SNAPSHOTRING_H
@@ -0,0 +1,379 @@
+#include <algorithm>
+#include "SpatialQuery.h"
+#include "Entity.h"
+#include "Terrain.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+constexpr RayHit RAY_MISS = { false, INFINITY, glm::vec3(0.0f), glm::vec3(0.0f), nullptr, WIN };
+
+// Entry distance of a ray into a box and the face it came through; an origin inside the box
+// counts as a hit at 0. Returns INFINITY on a miss.
+float slab_test(glm::vec2 box_min, glm::vec2 box_max, glm::vec2 origin, glm::vec2 direction, glm::vec2& normal) {
+    float entry = -INFINITY, exit = INFINITY;
+    int entry_axis = -1;
+
+    for (int axis = 0; axis < 2; axis++) {
+        if (direction[axis] == 0.0f) {
+            if (origin[axis] < box_min[axis] || origin[axis] > box_max[axis]) return INFINITY;
+            continue;
+        }
+
+        float near = ((direction[axis] > 0.0f ? box_min[axis] : box_max[axis]) - origin[axis]) / direction[axis];
+        float far = ((direction[axis] > 0.0f ? box_max[axis] : box_min[axis]) - origin[axis]) / direction[axis];
+
+        if (near > entry) { entry = near; entry_axis = axis; }
+        if (far < exit) exit = far;
+    }
+
+    if (entry > exit || exit < 0.0f) return INFINITY;
+
+    if (entry < 0.0f) {
+        normal = -direction;
+        return 0.0f;
+    }
+
+    normal = glm::vec2(0.0f);
+    normal[entry_axis] = direction[entry_axis] > 0.0f ? -1.0f : 1.0f;
+    return entry;
+}
+
+// Separation of two boxes, negative (the shallower axis) when they overlap
+float box_gap(glm::vec2 centre, glm::vec2 half_extents, glm::vec2 box_min, glm::vec2 box_max) {
+    glm::vec2 box_centre = (box_min + box_max) * 0.5f,
+              box_half = (box_max - box_min) * 0.5f;
+    glm::vec2 gap = glm::abs(centre - box_centre) - (half_extents + box_half);
+
+    if (gap.x < 0.0f && gap.y < 0.0f) return std::max(gap.x, gap.y);
+    return glm::length(glm::max(gap, glm::vec2(0.0f)));
+}
+
+// ––––– BUILDING ––––– //
+void SpatialQuery::build(const Entity* colliders, int collider_count, const Terrain* terrain) {
+    MEMORY_SCOPE(MEMORY_PHYSICS);
+    m_terrain = terrain;
+    m_items.clear();
+
+    for (int i = 0; i < collider_count; i++) {
+        const Entity& collider = colliders[i];
+        if (!collider.is_active()) continue;
+
+        glm::vec2 centre(collider.get_position().x, collider.get_position().y),
+                  half(collider.get_width() / 2.0f, collider.get_height() / 2.0f);
+        m_items.push_back(Item { centre - half, centre + half, &collider, collider.get_entity_type() });
+    }
+
+    m_cell_start.assign(1, 0);
+    m_cell_items.clear();
+    m_columns = m_rows = 0;
+    if (m_items.empty()) { return; }
+
+    // ––––– GRID ––––– //
+    // Cells at least as large as the largest collider, so each spans a handful of cells at most
+    glm::vec2 minimum = m_items[0].m_min,
+              maximum = m_items[0].m_max;
+    float largest = 0.0f;
+
+    for (const Item& item : m_items) {
+        minimum = glm::min(minimum, item.m_min);
+        maximum = glm::max(maximum, item.m_max);
+        largest = std::max(largest, std::max(item.m_max.x - item.m_min.x, item.m_max.y - item.m_min.y));
+    }
+
+    glm::vec2 extent = maximum - minimum;
+    m_cell_size = std::max(largest, std::max(extent.x, extent.y) / MAX_CELLS_PER_AXIS);
+    if (m_cell_size <= 0.0f) m_cell_size = 1.0f;
+
+    m_origin = minimum;
+    m_columns = (int)(extent.x / m_cell_size) + 1;
+    m_rows = (int)(extent.y / m_cell_size) + 1;
+
+    // ––––– BUCKETS ––––– //
+    // Count, prefix-sum, fill: every cell's items end up contiguous in m_cell_items
+    m_cell_start.assign(m_columns * m_rows + 1, 0);
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            for (int cell = 0; cell < m_columns * m_rows; cell++) m_cell_start[cell + 1] += m_cell_start[cell];
+            m_cell_items.resize(m_cell_start.back());
+        }
+
+        std::vector<int> cursor(m_cell_start.begin(), m_cell_start.end() - 1);
+
+        for (int i = 0; i < (int)m_items.size(); i++) {
+            const Item& item = m_items[i];
+            for (int row = row_of(item.m_min.y); row <= row_of(item.m_max.y); row++) {
+                for (int column = column_of(item.m_min.x); column <= column_of(item.m_max.x); column++) {
+                    int cell = row * m_columns + column;
+                    if (pass == 0) m_cell_start[cell + 1]++;
+                    else m_cell_items[cursor[cell]++] = i;
+                }
+            }
+        }
+    }
+}
+
+int const SpatialQuery::column_of(float x) const {
+    int column = (int)floorf((x - m_origin.x) / m_cell_size);
+    return std::clamp(column, 0, m_columns - 1);
+}
+
+int const SpatialQuery::row_of(float y) const {
+    int row = (int)floorf((y - m_origin.y) / m_cell_size);
+    return std::clamp(row, 0, m_rows - 1);
+}
+
+// ––––– RAYCASTS ––––– //
+// Walks the grid cell by cell along the ray (DDA) and stops as soon as the closest hit so far
+// is nearer than the cell being left
+RayHit const SpatialQuery::raycast_items(glm::vec2 origin, glm::vec2 direction, float max_distance) const {
+    RayHit best = RAY_MISS;
+    if (m_items.empty()) { return best; }
+
+    glm::vec2 grid_min = m_origin,
+              grid_max = m_origin + glm::vec2(m_columns, m_rows) * m_cell_size;
+    glm::vec2 grid_normal;
+    float start = slab_test(grid_min, grid_max, origin, direction, grid_normal);
+    if (!std::isfinite(start) || start > max_distance) { return best; }
+
+    glm::vec2 entry = origin + direction * start;
+    int column = column_of(entry.x),
+        row = row_of(entry.y);
+
+    int step_x = direction.x > 0.0f ? 1 : -1,
+        step_y = direction.y > 0.0f ? 1 : -1;
+    float next_x = direction.x == 0.0f ? INFINITY
+                 : (m_origin.x + (column + (step_x > 0 ? 1 : 0)) * m_cell_size - origin.x) / direction.x;
+    float next_y = direction.y == 0.0f ? INFINITY
+                 : (m_origin.y + (row + (step_y > 0 ? 1 : 0)) * m_cell_size - origin.y) / direction.y;
+    float delta_x = direction.x == 0.0f ? INFINITY : m_cell_size / fabsf(direction.x),
+          delta_y = direction.y == 0.0f ? INFINITY : m_cell_size / fabsf(direction.y);
+
+    while (true) {
+        int cell = row * m_columns + column;
+
+        for (int index = m_cell_start[cell]; index < m_cell_start[cell + 1]; index++) {
+            const Item& item = m_items[m_cell_items[index]];
+            glm::vec2 normal;
+            float distance = slab_test(item.m_min, item.m_max, origin, direction, normal);
+
+            if (distance <= max_distance && distance < best.m_distance) {
+                glm::vec2 point = origin + direction * distance;
+                best = RayHit { true, distance, glm::vec3(point, 0.0f), glm::vec3(normal, 0.0f), item.m_entity, item.m_type };
+            }
+        }
+
+        float leave = std::min(next_x, next_y);
+        if (best.m_distance <= leave || leave > max_distance) break;
+
+        if (next_x < next_y) { column += step_x; next_x += delta_x; }
+        else                 { row += step_y;    next_y += delta_y; }
+
+        if (column < 0 || column >= m_columns || row < 0 || row >= m_rows) break;
+    }
+
+    return best;
+}
+
+// Column by column over the heightfield; inside a column the gap between ray and ground is linear
+RayHit const SpatialQuery::raycast_terrain(glm::vec2 origin, glm::vec2 direction, float max_distance) const {
+    RayHit best = RAY_MISS;
+    if (m_terrain == nullptr || !m_terrain->is_built()) { return best; }
+
+    float left = m_terrain->get_left(),
+          right = m_terrain->get_right(),
+          column_width = m_terrain->get_column_width();
+
+    // Part of the ray above the terrain's x range
+    float start = 0.0f, end = max_distance;
+    if (direction.x == 0.0f) {
+        if (origin.x < left || origin.x > right) { return best; }
+    } else {
+        float to_left = (left - origin.x) / direction.x,
+              to_right = (right - origin.x) / direction.x;
+        start = std::max(start, std::min(to_left, to_right));
+        end = std::min(end, std::max(to_left, to_right));
+    }
+    // Unbounded and straight up or down: the ground is met by the floor at the latest, or never
+    if (std::isinf(end)) {
+        if (direction.y < 0.0f) end = start + (origin.y + direction.y * start - m_terrain->get_floor()) / -direction.y;
+        else end = start;
+    }
+    if (start > end) { return best; }
+
+    auto gap = [&](float distance) {
+        glm::vec2 point = origin + direction * distance;
+        return point.y - m_terrain->height_at(point.x);
+    };
+
+    // Step by column index rather than by position, so a steep ray cannot stall on a boundary
+    int column = m_terrain->column_at(origin.x + direction.x * start),
+        step = direction.x > 0.0f ? 1 : -1;
+    float distance = start;
+
+    while (true) {
+        float column_left = left + column * column_width;
+
+        float column_end = end;
+        if (direction.x > 0.0f) column_end = std::min(end, (column_left + column_width - origin.x) / direction.x);
+        else if (direction.x < 0.0f) column_end = std::min(end, (column_left - origin.x) / direction.x);
+        column_end = std::max(column_end, distance);
+
+        float gap_start = gap(distance),
+              gap_end = gap(column_end);
+
+        if (gap_start <= 0.0f || gap_end <= 0.0f) {
+            float hit = gap_start <= 0.0f ? distance : distance + (column_end - distance) * gap_start / (gap_start - gap_end);
+            glm::vec2 point = origin + direction * hit;
+            return RayHit { true, hit, glm::vec3(point, 0.0f), m_terrain->normal_at(column_left + column_width / 2.0f), nullptr,
+                            m_terrain->pad_at(point.x) >= 0 ? LANDING_PAD : TERRAIN };
+        }
+
+        column += step;
+        if (column_end >= end || column < 0 || column >= m_terrain->get_column_count()) break;
+        distance = column_end;
+    }
+
+    return best;
+}
+
+RayHit const SpatialQuery::raycast(const Ray& ray) const {
+    glm::vec2 origin(ray.m_origin.x, ray.m_origin.y),
+              direction(ray.m_direction.x, ray.m_direction.y);
+
+    float length = glm::length(direction);
+    if (length == 0.0f) { return RAY_MISS; }
+    direction /= length;
+
+    RayHit item_hit = raycast_items(origin, direction, ray.m_max_distance);
+    RayHit terrain_hit = raycast_terrain(origin, direction, std::min(ray.m_max_distance, item_hit.m_distance));
+
+    return terrain_hit.m_hit && terrain_hit.m_distance < item_hit.m_distance ? terrain_hit : item_hit;
+}
+
+void SpatialQuery::raycast_batch(const Ray* rays, RayHit* hits, int count, JobSystem* job_system) const {
+    auto cast = [this, rays, hits](int begin, int end) {
+        for (int i = begin; i < end; i++) hits[i] = raycast(rays[i]);
+    };
+
+    if (job_system != nullptr) job_system->parallel_for(count, BATCH_CHUNK_SIZE, cast);
+    else cast(0, count);
+}
+
+// ––––– OVERLAPS ––––– //
+int const SpatialQuery::overlap_box(glm::vec3 centre, glm::vec3 half_extents, const Entity** results, int max_results) const {
+    if (m_items.empty()) { return 0; }
+
+    glm::vec2 query_min = glm::vec2(centre) - glm::vec2(half_extents),
+              query_max = glm::vec2(centre) + glm::vec2(half_extents);
+
+    int first_column = column_of(query_min.x), last_column = column_of(query_max.x),
+        first_row = row_of(query_min.y), last_row = row_of(query_max.y);
+    int count = 0;
+
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            int cell = row * m_columns + column;
+
+            for (int index = m_cell_start[cell]; index < m_cell_start[cell + 1]; index++) {
+                const Item& item = m_items[m_cell_items[index]];
+
+                // A collider spanning several cells is only reported from the first one both share
+                if (column != std::max(column_of(item.m_min.x), first_column) || row != std::max(row_of(item.m_min.y), first_row)) continue;
+
+                if (item.m_min.x < query_max.x && item.m_max.x > query_min.x && item.m_min.y < query_max.y && item.m_max.y > query_min.y) {
+                    if (count == max_results) return count;
+                    results[count++] = item.m_entity;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+int const SpatialQuery::overlap_circle(glm::vec3 centre, float radius, const Entity** results, int max_results) const {
+    if (m_items.empty()) { return 0; }
+
+    glm::vec2 point(centre);
+    int first_column = column_of(point.x - radius), last_column = column_of(point.x + radius),
+        first_row = row_of(point.y - radius), last_row = row_of(point.y + radius);
+    int count = 0;
+
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            int cell = row * m_columns + column;
+
+            for (int index = m_cell_start[cell]; index < m_cell_start[cell + 1]; index++) {
+                const Item& item = m_items[m_cell_items[index]];
+                if (column != std::max(column_of(item.m_min.x), first_column) || row != std::max(row_of(item.m_min.y), first_row)) continue;
+
+                glm::vec2 closest = glm::clamp(point, item.m_min, item.m_max);
+                glm::vec2 offset = point - closest;
+
+                if (glm::dot(offset, offset) < radius * radius) {
+                    if (count == max_results) return count;
+                    results[count++] = item.m_entity;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+// ––––– DISTANCES ––––– //
+// Rings of cells around the box's cell, stopping once a ring cannot hold anything closer
+const Entity* SpatialQuery::nearest(glm::vec3 centre, glm::vec3 half_extents, float max_distance, float* distance) const {
+    const Entity* nearest_entity = nullptr;
+    float best = max_distance;
+    if (distance != nullptr) *distance = INFINITY;
+    if (m_items.empty()) { return nullptr; }
+
+    glm::vec2 point(centre), half(half_extents);
+    int centre_column = column_of(point.x),
+        centre_row = row_of(point.y);
+    float reach = glm::length(half);
+    int ring_limit = std::max(m_columns, m_rows);
+
+    for (int ring = 0; ring <= ring_limit; ring++) {
+        if (ring > 0 && (ring - 1) * m_cell_size - reach > best) break;
+
+        for (int row = centre_row - ring; row <= centre_row + ring; row++) {
+            if (row < 0 || row >= m_rows) continue;
+
+            // Only the outline of the ring; the inside was searched already
+            int column_step = (row == centre_row - ring || row == centre_row + ring) ? 1 : std::max(2 * ring, 1);
+            for (int column = centre_column - ring; column <= centre_column + ring; column += column_step) {
+                if (column < 0 || column >= m_columns) continue;
+                int cell = row * m_columns + column;
+
+                for (int index = m_cell_start[cell]; index < m_cell_start[cell + 1]; index++) {
+                    const Item& item = m_items[m_cell_items[index]];
+                    float gap = box_gap(point, half, item.m_min, item.m_max);
+
+                    if (gap <= best) {
+                        best = gap;
+                        nearest_entity = item.m_entity;
+                    }
+                }
+            }
+        }
+    }
+
+    if (distance != nullptr && nearest_entity != nullptr) *distance = best;
+    return nearest_entity;
+}
+
+float const SpatialQuery::ground_clearance(glm::vec3 centre, glm::vec3 half_extents) const {
+    if (m_terrain == nullptr || !m_terrain->is_built()) { return INFINITY; }
+
+    float ground = std::max(m_terrain->height_at(centre.x),
+                            std::max(m_terrain->height_at(centre.x - half_extents.x), m_terrain->height_at(centre.x + half_extents.x)));
+    return centre.y - half_extents.y - ground;
+}
+
+float const SpatialQuery::altitude(glm::vec3 position, float max_distance) const {
+    RayHit hit = raycast(Ray { position, glm::vec3(0.0f, -1.0f, 0.0f), max_distance });
+    return hit.m_hit ? hit.m_distance : INFINITY;
+}
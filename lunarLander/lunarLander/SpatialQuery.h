@@ -0,0 +1,90 @@
+#ifndef SPATIALQUERY_H
+#define SPATIALQUERY_H
+
+#include <cmath>
+#include <vector>
+#include "glm/glm.hpp"
+#include "EntityType.h"
+
+class Entity;
+class Terrain;
+class JobSystem;
+
+struct Ray {
+    glm::vec3 m_origin;
+    glm::vec3 m_direction;          // does not need to be normalised
+    float m_max_distance;
+};
+
+struct RayHit {
+    bool m_hit;
+    float m_distance;
+    glm::vec3 m_point;
+    glm::vec3 m_normal;
+    const Entity* m_entity;         // nullptr when the terrain was hit
+    EntityType m_type;
+};
+
+// Answers "what is around here" questions about a level's colliders and terrain: raycasts (one
+// or a batch), box and circle overlaps, and the nearest collider to a box.
+//
+// build() copies each active collider's box into a uniform grid, so the query is a snapshot of
+// the level at that moment. Every query is const and touches nothing but the snapshot and the
+// (immutable) terrain, so any number of worker threads can query while the live entities are
+// being stepped. Entity pointers in results identify colliders; the query never reads them.
+class SpatialQuery {
+private:
+    struct Item {
+        glm::vec2 m_min, m_max;
+        const Entity* m_entity;
+        EntityType m_type;
+    };
+
+    std::vector<Item> m_items;
+    std::vector<int> m_cell_start;          // m_columns * m_rows + 1 offsets into m_cell_items
+    std::vector<int> m_cell_items;
+
+    glm::vec2 m_origin = glm::vec2(0.0f);
+    float m_cell_size = 1.0f;
+    int m_columns = 0,
+        m_rows = 0;
+
+    const Terrain* m_terrain = nullptr;
+
+    int const column_of(float x) const;
+    int const row_of(float y) const;
+    RayHit const raycast_items(glm::vec2 origin, glm::vec2 direction, float max_distance) const;
+    RayHit const raycast_terrain(glm::vec2 origin, glm::vec2 direction, float max_distance) const;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int MAX_CELLS_PER_AXIS = 64;
+    static constexpr int BATCH_CHUNK_SIZE = 256;    // rays per job in raycast_batch()
+
+    // ————— METHODS ————— //
+    void build(const Entity* colliders, int collider_count, const Terrain* terrain = nullptr);
+
+    RayHit const raycast(const Ray& ray) const;
+    void raycast_batch(const Ray* rays, RayHit* hits, int count, JobSystem* job_system = nullptr) const;
+
+    // Fill `results` with up to `max_results` colliders and return how many overlap
+    int const overlap_box(glm::vec3 centre, glm::vec3 half_extents, const Entity** results, int max_results) const;
+    int const overlap_circle(glm::vec3 centre, float radius, const Entity** results, int max_results) const;
+
+    // Closest collider box within `max_distance` of the given box; `distance` is negative when
+    // they overlap (how deep). Returns nullptr if there is none.
+    const Entity* nearest(glm::vec3 centre, glm::vec3 half_extents, float max_distance, float* distance = nullptr) const;
+
+    // Height of a box's bottom edge above the terrain directly beneath it, INFINITY without terrain
+    float const ground_clearance(glm::vec3 centre, glm::vec3 half_extents) const;
+
+    // Distance straight down to the first collider or terrain, INFINITY if there is nothing below
+    float const altitude(glm::vec3 position, float max_distance = INFINITY) const;
+
+    // ————— GETTERS ————— //
+    int const get_item_count() const { return (int)m_items.size(); }
+    int const get_cell_count() const { return m_columns * m_rows; }
+    float const get_cell_size() const { return m_cell_size; }
+};
+
+#endif // SPATIALQUERY_H
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include "StartupTimeline.h"
+#include "Profiler.h"
+#include "Logger.h"
+
+StartupTimeline g_startup;
+
+constexpr double NANOSECONDS_IN_MILLISECOND = 1e6;
+constexpr int MAX_REPORT_DEPTH = 8;         // deeper phases are indented no further
+
+void StartupTimeline::start() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_phases.clear();
+    m_phases.reserve(64);
+
+    m_origin = Profiler::now();
+    m_first_frame = 0;
+    m_depth = 0;
+    m_is_reported = false;
+}
+
+int StartupTimeline::begin(const char* name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_phases.push_back({ name, Profiler::now(), 0, m_depth++, false });
+    return (int)m_phases.size() - 1;
+}
+
+void StartupTimeline::end(int phase) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_phases[phase].m_end = Profiler::now();
+    m_depth--;
+}
+
+void StartupTimeline::record(const char* name, uint64_t start, uint64_t end) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_phases.push_back({ name, start, end, 0, true });
+}
+
+void StartupTimeline::finish_first_frame(uint64_t frame_start) {
+    if (has_first_frame()) { return; }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_first_frame = Profiler::now();
+    m_phases.push_back({ "first frame", frame_start, m_first_frame, 0, false });
+}
+
+// Critical-path phases read as a share of the time to first frame; the untimed gaps between the
+// top-level ones are what no phase accounts for
+void StartupTimeline::report() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_is_reported) { return; }
+    m_is_reported = true;
+
+    std::vector<StartupPhase> phases = m_phases;
+    std::stable_sort(phases.begin(), phases.end(), [](const StartupPhase& a, const StartupPhase& b) { return a.m_start < b.m_start; });
+
+    double total_ms = (m_first_frame != 0 ? m_first_frame - m_origin : Profiler::now() - m_origin) / NANOSECONDS_IN_MILLISECOND;
+    double timed_ms = 0.0;
+
+    LOG_INFO("Startup: first frame after %.1f ms", total_ms);
+    for (const StartupPhase& phase : phases) {
+        if (phase.m_end == 0) continue;
+
+        double start_ms = (phase.m_start - m_origin) / NANOSECONDS_IN_MILLISECOND,
+               duration_ms = (phase.m_end - phase.m_start) / NANOSECONDS_IN_MILLISECOND;
+        if (!phase.m_is_background && phase.m_depth == 0) timed_ms += duration_ms;
+
+        int indent = std::min(phase.m_depth, MAX_REPORT_DEPTH) * 2;
+        if (phase.m_is_background) {
+            LOG_INFO("Startup %8.1f ms %8.1f ms        %*s%s (background)", start_ms, duration_ms, indent, "", phase.m_name);
+        } else {
+            LOG_INFO("Startup %8.1f ms %8.1f ms %5.1f%% %*s%s", start_ms, duration_ms, 100.0 * duration_ms / total_ms, indent, "", phase.m_name);
+        }
+    }
+    LOG_INFO("Startup %20.1f ms %5.1f%% untimed", total_ms - timed_ms, 100.0 * (total_ms - timed_ms) / total_ms);
+}
@@ -0,0 +1,67 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct StartupPhase {
+    const char* m_name;
+    uint64_t m_start, m_end;                // Profiler::now(); m_end is 0 while the phase runs
+    int m_depth;                            // nesting on the main thread
+    bool m_is_background;                   // ran on another thread, off the critical path
+};
+
+// Where the time to the first frame goes. Main-thread phases nest (STARTUP_SCOPE) and together
+// are the critical path; work handed to other threads is recorded whole with record() and shows
+// up next to it. report() logs every phase with its offset from start() and its share of the
+// time to first frame, once the background work the caller waits for is done.
+class StartupTimeline {
+private:
+    std::vector<StartupPhase> m_phases;
+    mutable std::mutex m_mutex;             // record() comes from other threads
+
+    uint64_t m_origin = 0;
+    uint64_t m_first_frame = 0;             // when the first frame had been presented
+    int m_depth = 0;
+    bool m_is_reported = false;
+
+public:
+    // ————— METHODS ————— //
+    void start();                           // as early in main() as possible
+
+    int begin(const char* name);
+    void end(int phase);
+    void record(const char* name, uint64_t start, uint64_t end);
+
+    // `frame_start` is when the first frame began; the frame becomes a phase of its own
+    void finish_first_frame(uint64_t frame_start);
+
+    void report();
+
+    // ————— GETTERS ————— //
+    bool const has_first_frame() const { return m_first_frame != 0; }
+    bool const is_reported() const { return m_is_reported; }
+    uint64_t const get_time_to_first_frame() const { return has_first_frame() ? m_first_frame - m_origin : 0; }
+};
+
+extern StartupTimeline g_startup;
+
+// Times its own lifetime as a startup phase; STARTUP_SCOPE declares one
+class StartupScope {
+private:
+    int m_phase;
+
+public:
+    explicit StartupScope(const char* name) : m_phase(g_startup.begin(name)) {}
+    ~StartupScope() { g_startup.end(m_phase); }
+
+    StartupScope(const StartupScope&) = delete;
+    StartupScope& operator=(const StartupScope&) = delete;
+};
+
+#define STARTUP_CONCATENATE_INNER(a, b) a##b
+#define STARTUP_CONCATENATE(a, b) STARTUP_CONCATENATE_INNER(a, b)
+#define STARTUP_SCOPE(name) StartupScope STARTUP_CONCATENATE(startup_scope_, __LINE__)(name)
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,157 @@
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include "Telemetry.h"
+
+#ifndef _WINDOWS
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ––––– PUBLISHER ––––– //
+TelemetryPublisher::~TelemetryPublisher() { close(); }
+
+#ifndef _WINDOWS
+
+bool TelemetryPublisher::open(const char* name) {
+    if (m_page != nullptr) { return true; }
+
+    if (name != nullptr) snprintf(m_name, sizeof(m_name), "%s", name);
+    else snprintf(m_name, sizeof(m_name), "/lunar_lander.%d", (int)getpid());
+
+    m_descriptor = shm_open(m_name, O_CREAT | O_RDWR, 0644);
+    if (m_descriptor < 0) { return false; }
+
+    if (ftruncate(m_descriptor, sizeof(TelemetryPage)) != 0) {
+        close();
+        return false;
+    }
+
+    void* memory = mmap(nullptr, sizeof(TelemetryPage), PROT_READ | PROT_WRITE, MAP_SHARED, m_descriptor, 0);
+    if (memory == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    // Version last, so a reader that finds the name early sees an unfinished page as a mismatch
+    m_page = new (memory) TelemetryPage();
+    m_page->m_magic = TELEMETRY_MAGIC;
+    m_page->m_size = sizeof(TelemetryPage);
+    m_page->m_pid = (int32_t)getpid();
+    m_page->m_sequence.store(0, std::memory_order_relaxed);
+    memset(&m_page->m_sample, 0, sizeof(m_page->m_sample));
+    std::atomic_thread_fence(std::memory_order_release);
+    m_page->m_version = TELEMETRY_VERSION;
+
+    return true;
+}
+
+void TelemetryPublisher::close() {
+    if (m_page != nullptr) munmap(m_page, sizeof(TelemetryPage));
+    if (m_descriptor >= 0) {
+        ::close(m_descriptor);
+        shm_unlink(m_name);
+    }
+
+    m_page = nullptr;
+    m_descriptor = -1;
+}
+
+#else
+
+bool TelemetryPublisher::open(const char* name) { return false; }
+void TelemetryPublisher::close() {}
+
+#endif
+
+void TelemetryPublisher::publish(const TelemetrySample& sample) {
+    if (m_page == nullptr) { return; }
+
+    uint64_t sequence = m_page->m_sequence.load(std::memory_order_relaxed);
+    m_page->m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(&m_page->m_sample, &sample, sizeof(sample));
+
+    m_page->m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// ––––– READER ––––– //
+TelemetryReader::~TelemetryReader() { close(); }
+
+#ifndef _WINDOWS
+
+bool TelemetryReader::open(const char* name) {
+    close();
+
+    m_descriptor = shm_open(name, O_RDONLY, 0);
+    if (m_descriptor < 0) { return false; }
+
+    // A game that crashed or was killed never unlinked its segment and nobody else will, so do it
+    // here. Every version starts with magic, version, size and pid, so old builds' are caught too.
+    uint32_t header[4];
+    if (pread(m_descriptor, header, sizeof(header), 0) == (ssize_t)sizeof(header) && header[0] == TELEMETRY_MAGIC &&
+        kill((pid_t)header[3], 0) != 0 && errno == ESRCH) {
+        close();
+        shm_unlink(name);
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(m_descriptor, &status) != 0 || (size_t)status.st_size < sizeof(TelemetryPage)) {
+        close();
+        return false;
+    }
+
+    void* memory = mmap(nullptr, sizeof(TelemetryPage), PROT_READ, MAP_SHARED, m_descriptor, 0);
+    if (memory == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    m_page = static_cast<const TelemetryPage*>(memory);
+    if (m_page->m_magic != TELEMETRY_MAGIC || m_page->m_version != TELEMETRY_VERSION || m_page->m_size != sizeof(TelemetryPage)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void TelemetryReader::close() {
+    if (m_page != nullptr) munmap(const_cast<TelemetryPage*>(m_page), sizeof(TelemetryPage));
+    if (m_descriptor >= 0) ::close(m_descriptor);
+
+    m_page = nullptr;
+    m_descriptor = -1;
+}
+
+#else
+
+bool TelemetryReader::open(const char* name) { return false; }
+void TelemetryReader::close() {}
+
+#endif
+
+bool TelemetryReader::read(TelemetrySample& sample, uint64_t* sequence) const {
+    if (m_page == nullptr) { return false; }
+
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint64_t before = m_page->m_sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+
+        memcpy(&sample, &m_page->m_sample, sizeof(sample));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_page->m_sequence.load(std::memory_order_relaxed) == before) {
+            if (sequence != nullptr) *sequence = before / 2;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,117 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <cstdint>
+
+// One frame's worth of live statistics. Plain fixed-width fields only: the layout is shared
+// with processes built separately, so add fields at the end and bump TELEMETRY_VERSION.
+struct TelemetrySample {
+    uint64_t m_frame;                   // frames rendered since start
+    uint64_t m_tick;                    // simulation steps into the current level
+    uint64_t m_frame_nanoseconds;       // wall time of the last frame
+    uint64_t m_step_nanoseconds;        // average simulation time per step in the last frame
+    uint64_t m_dropped_steps;           // steps the frame clock gave up on after stalls
+
+    uint32_t m_steps;                   // simulation steps run in the last frame
+    uint32_t m_pairs_tested;            // narrowphase pairs tested in the last frame
+    uint32_t m_draw_calls;              // in the last frame
+    float m_fuel;                       // the player's
+
+    uint32_t m_body_count;
+    uint32_t m_awake_count;
+    uint32_t m_collider_count;
+    uint32_t m_sleeping_count;
+
+    uint32_t m_arena_allocations;       // objects in the level arena
+    uint32_t m_arena_blocks;
+    uint64_t m_arena_bytes;
+    uint64_t m_arena_peak_bytes;
+
+    uint32_t m_outcome;                 // TelemetryOutcome bits
+    float m_altitude;                   // from the player's feet to whatever is straight below, INFINITY over nothing
+
+    uint64_t m_heap_bytes;              // live, through operator new and stb_image
+    uint64_t m_heap_peak_bytes;
+    uint64_t m_gpu_bytes;               // estimated, textures and buffers
+    uint64_t m_frame_allocation_bytes;  // allocated in the last frame
+    uint32_t m_frame_allocations;
+    uint32_t m_heap_allocations;        // live
+};
+
+enum TelemetryOutcome { OUTCOME_WIN = 1, OUTCOME_LOSE = 2, OUTCOME_NO_FUEL = 4 };
+
+// What sits at the start of the shared-memory segment. m_sequence is a seqlock: the writer makes
+// it odd, writes the sample and makes it even again, and a reader retries until it sees the same
+// even value before and after copying. The game never waits on a reader.
+struct TelemetryPage {
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint32_t m_size;                    // sizeof(TelemetryPage) as the writer was built
+    int32_t m_pid;
+    std::atomic<uint64_t> m_sequence;
+    TelemetrySample m_sample;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock has to work across processes");
+
+constexpr uint32_t TELEMETRY_MAGIC = 0x4D544C4C;     // "LLTM"
+constexpr uint32_t TELEMETRY_VERSION = 2;
+
+// Publishes a TelemetryPage under a POSIX shared-memory name (/lunar_lander.<pid> by default, so
+// any number of instances can run side by side). Readers map the same name read-only.
+class TelemetryPublisher {
+private:
+    TelemetryPage* m_page = nullptr;
+    int m_descriptor = -1;
+    char m_name[64] = {};
+
+public:
+    // ————— METHODS ————— //
+    TelemetryPublisher() = default;
+    ~TelemetryPublisher();
+
+    TelemetryPublisher(const TelemetryPublisher&) = delete;
+    TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+
+    bool open(const char* name = nullptr);
+    void close();                       // also removes the name
+
+    void publish(const TelemetrySample& sample);
+
+    // ————— GETTERS ————— //
+    bool const is_open() const { return m_page != nullptr; }
+    const char* get_name() const { return m_name; }
+};
+
+// Read side, for dashboards and the load-test harness
+class TelemetryReader {
+private:
+    const TelemetryPage* m_page = nullptr;
+    int m_descriptor = -1;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr int MAX_READ_ATTEMPTS = 64;
+
+    // ————— METHODS ————— //
+    TelemetryReader() = default;
+    ~TelemetryReader();
+
+    TelemetryReader(const TelemetryReader&) = delete;
+    TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+    // Fails if the name does not exist, holds a different layout version or was left behind by a
+    // game that is no longer running (that segment is removed)
+    bool open(const char* name);
+    void close();
+
+    // A consistent copy of the latest sample; false if the writer kept it busy throughout
+    bool read(TelemetrySample& sample, uint64_t* sequence = nullptr) const;
+
+    // ————— GETTERS ————— //
+    bool const is_open() const { return m_page != nullptr; }
+    int const get_pid() const { return m_page != nullptr ? m_page->m_pid : 0; }
+};
+
+#endif // TELEMETRY_H
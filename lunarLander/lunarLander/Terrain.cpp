@@ -0,0 +1,183 @@
+#include <cmath>
+#include "Terrain.h"
+#include "Entity.h"
+#include "ContactEvent.h"
+#include "Profiler.h"
+#include "MemoryTracker.h"
+
+void Terrain::build(float left, float right, int column_count, float floor, const float* heights, const PadLayout* pads, int pad_count) {
+    MEMORY_SCOPE(MEMORY_TERRAIN);
+    m_left = left;
+    m_column_count = column_count;
+    m_column_width = (right - left) / (float)column_count;
+    m_inverse_column_width = 1.0f / m_column_width;
+    m_floor = floor;
+
+    m_heights.assign(heights, heights + column_count + 1);
+    m_column_pad.assign(column_count, -1);
+    m_pad_first_sample.clear();
+    m_pad_last_sample.clear();
+
+    // ––––– PADS ––––– //
+    for (int p = 0; p < pad_count; p++) {
+        int first = (int)lroundf((pads[p].m_left - left) * m_inverse_column_width),
+            last = (int)lroundf((pads[p].m_right - left) * m_inverse_column_width);
+        if (first < 0) first = 0;
+        if (last > column_count) last = column_count;
+        if (last <= first) continue;
+
+        int pad_index = (int)m_pad_first_sample.size();
+        for (int sample = first; sample <= last; sample++) m_heights[sample] = pads[p].m_y;
+        for (int column = first; column < last; column++) m_column_pad[column] = pad_index;
+
+        m_pad_first_sample.push_back(first);
+        m_pad_last_sample.push_back(last);
+    }
+
+    // ––––– SLOPES AND NORMALS ––––– //
+    m_slopes.resize(column_count);
+    m_normals.resize(column_count);
+
+    for (int column = 0; column < column_count; column++) {
+        float rise = m_heights[column + 1] - m_heights[column];
+        m_slopes[column] = rise * m_inverse_column_width;
+        m_normals[column] = glm::normalize(glm::vec3(-rise, m_column_width, 0.0f));
+    }
+}
+
+void Terrain::generate(float left, float right, int column_count, float base, float roughness, float floor, const PadLayout* pads, int pad_count) {
+    MEMORY_SCOPE(MEMORY_TERRAIN);
+    std::vector<float> heights(column_count + 1);
+
+    for (int sample = 0; sample <= column_count; sample++) {
+        float x = left + (right - left) * (float)sample / (float)column_count;
+        heights[sample] = terrain_height(x, base, roughness);
+    }
+
+    build(left, right, column_count, floor, heights.data(), pads, pad_count);
+}
+
+int const Terrain::column_at(float x) const {
+    int column = (int)floorf((x - m_left) * m_inverse_column_width);
+    if (column < 0) return 0;
+    if (column >= m_column_count) return m_column_count - 1;
+    return column;
+}
+
+float const Terrain::height_at(float x) const {
+    int column = column_at(x);
+    return m_heights[column] + m_slopes[column] * (x - (m_left + column * m_column_width));
+}
+
+bool Terrain::collide(Entity* body, ContactBuffer& contacts) const {
+    if (m_column_count == 0 || !body->is_active() || body->is_static() || body->is_sleeping()) { return false; }
+    PROFILE_SCOPE("Terrain::collide");
+    contacts.add_pairs_tested(1);
+
+    glm::vec3 position = body->get_position();
+    float half_width = body->get_width() / 2.0f,
+          bottom = position.y - body->get_height() / 2.0f;
+    float left = position.x - half_width,
+          right = position.x + half_width;
+
+    if (right < m_left || left > get_right()) { return false; }
+    if (left < m_left) left = m_left;
+    if (right > get_right()) right = get_right();
+
+    // The highest ground under the footprint is at one of its edges or at a sample in between
+    int first = column_at(left),
+        last = column_at(right);
+    // Columns are half-open, so a right edge exactly on a boundary ends in the column before it
+    if (last > first && m_left + last * m_column_width >= right) last--;
+
+    float ground = height_at(left);
+    glm::vec3 normal = m_normals[first];
+
+    float right_height = height_at(right);
+    if (right_height > ground) { ground = right_height; normal = m_normals[last]; }
+
+    for (int sample = first + 1; sample <= last; sample++) {
+        if (m_heights[sample] > ground) {
+            ground = m_heights[sample];
+            normal = glm::normalize(m_normals[sample - 1] + m_normals[sample]);
+        }
+    }
+
+    float depth = ground - bottom;
+    if (depth <= 0.0f) { return false; }
+
+    position.y += depth;
+    body->set_position(position);
+
+    PhysicsComponent* physics = body->get_physics();
+    float into_ground = glm::dot(physics->m_velocity, normal);
+    if (into_ground < 0.0f) physics->m_velocity -= into_ground * normal;
+    physics->m_collided_bottom = true;
+
+    // Only a body resting entirely on one pad has landed; straddling its edge is a crash
+    int pad = m_column_pad[first];
+    bool on_pad = pad >= 0 && pad == m_column_pad[last];
+
+    contacts.add_contact(body, on_pad ? LANDING_PAD : TERRAIN, normal, depth);
+    body->update_model_matrix();
+
+    return true;
+}
+
+void Terrain::upload() {
+    MEMORY_SCOPE(MEMORY_TERRAIN);
+    std::vector<float> vertices;
+    vertices.reserve((m_column_count + 1) * 4);
+
+    for (int sample = 0; sample <= m_column_count; sample++) {
+        float x = m_left + sample * m_column_width;
+        vertices.push_back(x);
+        vertices.push_back(m_heights[sample]);
+        vertices.push_back(x);
+        vertices.push_back(m_floor);
+    }
+
+    if (m_vertex_buffer == 0) glGenBuffers(1, &m_vertex_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // Uploading again replaces the buffer's storage
+    g_memory.remove_gpu_bytes(MEMORY_TERRAIN, m_vertex_buffer_bytes);
+    m_vertex_buffer_bytes = vertices.size() * sizeof(float);
+    g_memory.add_gpu_bytes(MEMORY_TERRAIN, m_vertex_buffer_bytes);
+}
+
+void Terrain::release() {
+    if (m_vertex_buffer != 0) glDeleteBuffers(1, &m_vertex_buffer);
+    m_vertex_buffer = 0;
+
+    g_memory.remove_gpu_bytes(MEMORY_TERRAIN, m_vertex_buffer_bytes);
+    m_vertex_buffer_bytes = 0;
+}
+
+void Terrain::render(ShaderProgram* program) const {
+    if (m_vertex_buffer == 0) { return; }
+
+    program->set_model_matrix(glm::mat4(1.0f));
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, nullptr);
+    glEnableVertexAttribArray(program->get_position_attribute());
+
+    program->set_colour(GROUND_RED, GROUND_GREEN, GROUND_BLUE, 1.0f);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, (m_column_count + 1) * 2);
+    program->count_draw_call();
+
+    // Two vertices per sample, so a pad is the strip from its first sample to its last
+    program->set_colour(PAD_RED, PAD_GREEN, PAD_BLUE, 1.0f);
+    for (int pad = 0; pad < get_pad_count(); pad++) {
+        int first = m_pad_first_sample[pad],
+            last = m_pad_last_sample[pad];
+        glDrawArrays(GL_TRIANGLE_STRIP, first * 2, (last - first + 1) * 2);
+        program->count_draw_call();
+    }
+
+    glDisableVertexAttribArray(program->get_position_attribute());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,73 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <vector>
+#include "glm/glm.hpp"
+#include "ShaderProgram.h"
+#include "Level.h"
+
+class Entity;
+class ContactBuffer;
+
+// Lunar ground as a heightfield: one height sample every m_column_width units from m_left,
+// joined by straight segments. Because the samples are evenly spaced, the column under any x
+// is a single multiply, so colliding a body costs the few columns under its footprint no
+// matter how long the terrain is. Slopes and normals are worked out once in build().
+//
+// Landing pads are flattened runs of columns. The whole profile is drawn as one triangle strip
+// (sample, floor, sample, floor, ...) kept in a static vertex buffer; pads are a sub-range of
+// the same strip drawn again in their own colour.
+class Terrain {
+private:
+    float m_left = 0.0f,
+          m_column_width = 1.0f,
+          m_inverse_column_width = 1.0f,
+          m_floor = 0.0f;
+    int m_column_count = 0;
+
+    std::vector<float> m_heights;           // m_column_count + 1 samples
+    std::vector<float> m_slopes;            // rise over run of each column's segment
+    std::vector<glm::vec3> m_normals;       // unit, pointing up out of the ground
+    std::vector<int> m_column_pad;          // pad index of each column, -1 for rough ground
+    std::vector<int> m_pad_first_sample, m_pad_last_sample;
+
+    GLuint m_vertex_buffer = 0;
+    size_t m_vertex_buffer_bytes = 0;       // what upload() reported to g_memory
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr float GROUND_RED = 0.55f, GROUND_GREEN = 0.53f, GROUND_BLUE = 0.5f,
+                           PAD_RED = 0.95f, PAD_GREEN = 0.8f, PAD_BLUE = 0.2f;
+
+    // ————— METHODS ————— //
+    // `heights` holds column_count + 1 samples; pads overwrite the samples they cover
+    void build(float left, float right, int column_count, float floor, const float* heights, const PadLayout* pads, int pad_count);
+
+    // Rolling hills around `base`, the same every run
+    void generate(float left, float right, int column_count, float base, float roughness, float floor, const PadLayout* pads, int pad_count);
+
+    // Pushes a body that sank into the ground back onto it, removes the velocity going into
+    // the slope and records a TERRAIN or LANDING_PAD contact. Returns whether it touched.
+    bool collide(Entity* body, ContactBuffer& contacts) const;
+
+    void upload();                          // needs a current GL context
+    void release();
+    void render(ShaderProgram* program) const;
+
+    // ————— GETTERS ————— //
+    int const column_at(float x) const;
+    float const height_at(float x) const;
+    glm::vec3 const normal_at(float x) const { return m_normals[column_at(x)]; }
+    float const slope_at(float x) const { return m_slopes[column_at(x)]; }
+    int const pad_at(float x) const { return m_column_pad[column_at(x)]; }
+
+    float const get_left() const { return m_left; }
+    float const get_right() const { return m_left + m_column_count * m_column_width; }
+    float const get_column_width() const { return m_column_width; }
+    float const get_floor() const { return m_floor; }
+    int const get_column_count() const { return m_column_count; }
+    int const get_pad_count() const { return (int)m_pad_first_sample.size(); }
+    bool const is_built() const { return m_column_count > 0; }
+};
+
+#endif // TERRAIN_H
@@ -0,0 +1,124 @@
+#include "TextureLoader.h"
+#include "stb_image.h"
+#include "Profiler.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+#include "StartupTimeline.h"
+
+TextureLoader::~TextureLoader() { shutdown(); }
+
+int TextureLoader::defer(const char* filepath) {
+    Entry entry;
+    entry.m_filepath = filepath;
+    m_entries.push_back(entry);
+    return (int)m_entries.size() - 1;
+}
+
+void TextureLoader::initialise(TextureUpload upload) { m_upload = upload; }
+
+void TextureLoader::start() {
+    if (m_thread.joinable()) { return; }
+
+    m_is_cancelled = false;
+    m_thread = std::thread(&TextureLoader::decode_loop, this);
+}
+
+// Textures not uploaded yet are dropped
+void TextureLoader::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_cancelled = true;
+    }
+    if (m_thread.joinable()) m_thread.join();
+
+    for (Entry& entry : m_entries) {
+        if (entry.m_pixels != nullptr) stbi_image_free(entry.m_pixels);
+        entry.m_pixels = nullptr;
+    }
+}
+
+void TextureLoader::decode_loop() {
+    MEMORY_SCOPE(MEMORY_TEXTURES);
+    g_profiler.set_thread_name("Texture loader");
+
+    for (Entry& entry : m_entries) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_is_cancelled) { return; }
+            if (entry.m_state != QUEUED) continue;      // require() got there first
+            entry.m_state = DECODING;
+        }
+
+        uint64_t start = Profiler::now();
+        decode(entry);
+        g_startup.record(entry.m_filepath, start, Profiler::now());
+    }
+}
+
+void TextureLoader::decode(Entry& entry) {
+    PROFILE_SCOPE("TextureLoader::decode");
+    int number_of_components;
+    unsigned char* pixels = stbi_load(entry.m_filepath, &entry.m_width, &entry.m_height, &number_of_components, STBI_rgb_alpha);
+    if (pixels == nullptr) LOG_ERROR("Unable to load image %s. Make sure the path is correct.", entry.m_filepath);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        entry.m_pixels = pixels;
+        entry.m_state = DECODED;
+    }
+    m_decoded_condition.notify_all();
+}
+
+// An image that failed to decode becomes resident as texture 0, and draws nothing
+void TextureLoader::make_resident(Entry& entry) {
+    if (entry.m_pixels != nullptr) {
+        entry.m_texture_id = m_upload(entry.m_pixels, entry.m_width, entry.m_height);
+        stbi_image_free(entry.m_pixels);
+        entry.m_pixels = nullptr;
+    }
+
+    entry.m_is_resident = true;
+    m_resident_count++;
+}
+
+void TextureLoader::poll() {
+    if (m_upload == nullptr || is_finished()) { return; }
+
+    for (Entry& entry : m_entries) {
+        if (entry.m_is_resident) continue;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (entry.m_state != DECODED) continue;
+        }
+
+        PROFILE_SCOPE("TextureLoader::upload");
+        make_resident(entry);
+        return;
+    }
+}
+
+GLuint TextureLoader::require(int handle) {
+    Entry& entry = m_entries[handle];
+    if (entry.m_is_resident) { return entry.m_texture_id; }
+
+    PROFILE_SCOPE("TextureLoader::require");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (entry.m_state == QUEUED) {
+        entry.m_state = DECODING;
+        lock.unlock();
+
+        MEMORY_SCOPE(MEMORY_TEXTURES);
+        decode(entry);
+        lock.lock();
+    }
+
+    m_decoded_condition.wait(lock, [&entry] { return entry.m_state == DECODED; });
+    lock.unlock();
+
+    make_resident(entry);
+    return entry.m_texture_id;
+}
+
+void TextureLoader::require_all() {
+    for (int handle = 0; handle < (int)m_entries.size(); handle++) require(handle);
+}
@@ -0,0 +1,77 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Turns decoded RGBA pixels into a texture; only ever called on the main thread
+typedef GLuint (*TextureUpload)(const unsigned char* rgba, int width, int height);
+
+// Textures the first frame can do without. defer() only notes the file; once start() is called
+// (after the first frame is up) a thread of its own decodes them in order, and poll() uploads
+// whatever is ready, one texture a frame. The thread is dedicated because a job-system job could
+// be run on the main thread inside someone's wait().
+//
+// Whatever is about to be drawn goes through require(), which makes that texture resident on the
+// spot: it takes the decode over if the loader has not got to it yet, or waits for it to finish.
+class TextureLoader {
+private:
+    enum EntryState { QUEUED, DECODING, DECODED };
+
+    struct Entry {
+        const char* m_filepath;
+        EntryState m_state = QUEUED;
+        unsigned char* m_pixels = nullptr;  // once DECODED, until uploaded
+        int m_width = 0,
+            m_height = 0;
+
+        // Main thread only
+        bool m_is_resident = false;
+        GLuint m_texture_id = 0;
+    };
+
+    std::vector<Entry> m_entries;           // fixed once start() is called
+    TextureUpload m_upload = nullptr;
+    int m_resident_count = 0;
+
+    std::thread m_thread;
+    std::mutex m_mutex;                     // guards m_state and the pixels that come with it
+    std::condition_variable m_decoded_condition;
+    bool m_is_cancelled = false;
+
+    void decode_loop();
+    void decode(Entry& entry);              // m_state must be DECODING, and owned by the caller
+    void make_resident(Entry& entry);
+
+public:
+    // ————— METHODS ————— //
+    TextureLoader() = default;
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    int defer(const char* filepath);        // returns the handle for require() and friends
+
+    void initialise(TextureUpload upload);  // before require() or poll()
+    void start();
+    void shutdown();
+
+    void poll();
+    GLuint require(int handle);
+    void require_all();
+
+    // ————— GETTERS ————— //
+    bool const is_finished() const { return m_resident_count == (int)m_entries.size(); }
+    GLuint const get_texture_id(int handle) const { return m_entries[handle].m_texture_id; }   // 0 until resident
+};
+
+#endif // TEXTURELOADER_H
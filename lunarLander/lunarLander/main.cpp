@@ -10,10 +10,7 @@
 
 #define GL_SILENCE_DEPRECATION
 #define STB_IMAGE_IMPLEMENTATION
-#define LOG(argument) std::cout << argument << '\n'
 #define GL_GLEXT_PROTOTYPES 1
-#define FIXED_TIMESTEP 0.0166666f
-#define PLATFORM_COUNT 5
 
 #ifdef _WINDOWS
 #include <GL/glew.h>
@@ -24,11 +21,39 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "MemoryTracker.h"
+
+// Decode buffers are counted like everything else, under their own tag
+#define STBI_MALLOC(size) memory_allocate((size), MEMORY_IMAGES)
+#define STBI_REALLOC(pointer, size) memory_reallocate((pointer), (size), MEMORY_IMAGES)
+#define STBI_FREE(pointer) memory_free(pointer)
 #include "stb_image.h"
 #include "cmath"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <vector>
 #include "Entity.h"
+#include "Level.h"
+#include "ContactEvent.h"
+#include "PhysicsWorld.h"
+#include "JobSystem.h"
+#include "LevelArena.h"
+#include "Terrain.h"
+#include "CollisionMask.h"
+#include "SnapshotRing.h"
+#include "GravityField.h"
+#include "FrameClock.h"
+#include "Profiler.h"
+#include "Logger.h"
+#include "Telemetry.h"
+#include "InputScript.h"
+#include "FrameTimings.h"
+#include "InputRecording.h"
+#include "StartupTimeline.h"
+#include "TextureLoader.h"
+#include "PerfCounters.h"
 
 // ––––– STRUCTS AND ENUMS ––––– //
 struct GameState {
@@ -40,6 +65,32 @@ struct GameState {
     Entity* nofuel;
 };
 
+struct LevelTextures {
+    GLuint bg;
+    int win;                // TextureLoader handles: these load after the first frame
+    int lose;
+    int nofuel;
+    GLuint pc;
+    GLuint shroom;
+    GLuint player;
+};
+
+// Lives in the level arena with the entities, so a snapshot of the arena covers it too
+struct LevelProgress {
+    int tick = 0;
+    bool win = false,
+         lose = false,
+         nofuel = false;
+};
+
+// Alpha masks for precise collision. The texel masks come straight out of load_texture; the
+// world ones are resampled to the size each sprite is drawn at.
+struct LevelMasks {
+    CollisionMask pc, shroom, player;
+    CollisionMask platforms[PLATFORM_COUNT];    // one per LEVEL_PLATFORMS entry
+    CollisionMask player_frames[16];            // one per frame of the 4x4 player sprite sheet
+};
+
 // ––––– CONSTANTS ––––– //
 constexpr int WINDOW_WIDTH = 640,
               WINDOW_HEIGHT = 480;
@@ -55,16 +106,48 @@ constexpr int VIEWPORT_X = 0,
               VIEWPORT_HEIGHT = WINDOW_HEIGHT;
 
 constexpr char V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
-               F_SHADER_PATH[] = "shaders/fragment_textured.glsl";
+               F_SHADER_PATH[] = "shaders/fragment_textured.glsl",
+               TERRAIN_V_SHADER_PATH[] = "shaders/vertex.glsl",
+               TERRAIN_F_SHADER_PATH[] = "shaders/fragment.glsl";
 
-constexpr float MILLISECONDS_IN_SECOND = 1000.0;
 constexpr char BG_FILEPATH[] = "bg.png",
                SPRITESHEET_FILEPATH[] = "ash.png",
                PC_FILEPATH[] = "pc.png",
                WIN_FILEPATH[] = "win.png",
                SHROOM_FILEPATH[] = "shroom.png",
                LOSE_FILEPATH[] = "lose.png",
-               NOFUEL_FILEPATH[] = "nofuel.png";
+               NOFUEL_FILEPATH[] = "nofuel.png",
+               PROFILE_FILEPATH[] = "profile.json";
+
+constexpr int REWIND_TICKS = 120;               // two seconds per press
+constexpr int MAX_CATCH_UP_STEPS = 8;           // after a stall, drop time beyond this many steps a frame
+constexpr float PROFILE_SECONDS = 10.0f;        // P writes out this much of the recent past
+
+constexpr bool PRECISE_COLLISION = true;     // pixel masks inside the hand-tuned boxes
+constexpr int PLAYER_SHEET_COLS = 4,
+              PLAYER_SHEET_ROWS = 4;
+constexpr float PLAYER_SPRITE_SIZE = 1.0f;      // the player's model matrix is never scaled
+
+// Live heap bytes each subsystem may hold (by MemoryTag); over it, a warning every few seconds
+constexpr uint64_t MEMORY_BUDGETS[MEMORY_TAG_COUNT] = {
+    256 * 1024,             // general
+    4 * 1024 * 1024,        // images: the largest PNG, decoded, while it loads
+    16 * 1024,              // textures
+    256 * 1024,             // collision
+    64 * 1024,              // shaders
+    64 * 1024,              // level
+    2 * 1024 * 1024,        // snapshots
+    64 * 1024,              // terrain
+    64 * 1024,              // physics
+    64 * 1024,              // jobs
+    2 * 1024 * 1024,        // logging
+    16 * 1024 * 1024,       // profiling
+    1024 * 1024,            // diagnostics
+};
+constexpr uint32_t FRAME_ALLOCATION_BUDGET = 16;        // a running level should hardly allocate at all
+constexpr float MEMORY_WARNING_SECONDS = 5.0f;
+
+constexpr const char* OUTCOME_NAMES[] = { "running", "won", "lost", "out of fuel" };     // by BatchOutcome
 
 constexpr int NUMBER_OF_TEXTURES = 1;
 constexpr GLint LEVEL_OF_DETAIL = 0;
@@ -72,43 +155,131 @@ constexpr GLint TEXTURE_BORDER = 0;
 
 // ––––– GLOBAL VARIABLES ––––– //
 GameState g_game_state;
+LevelTextures g_textures;
+LevelMasks g_masks;
+LevelArena g_level_arena;
+ContactBuffer g_contacts;
+PhysicsWorld g_physics_world;
+Terrain g_terrain;
+GravityField g_gravity;
 
 SDL_Window* g_display_window;
 bool g_game_is_running = true;
-bool g_win = false,
-     g_lose = false,
-     g_nofuel = false;
+LevelProgress* g_progress;
+SnapshotRing g_snapshots;
 
 
 ShaderProgram g_shader_program;
+ShaderProgram g_terrain_program;
+JobSystem g_job_system;
 glm::mat4 g_view_matrix, g_projection_matrix;
 
-float g_previous_ticks = 0.0f;
-float g_accumulator = 0.0f;
+FrameClock g_frame_clock;
+TextureLoader g_texture_loader;
+
+TelemetryPublisher g_telemetry;
+TelemetrySample g_telemetry_sample;
+uint64_t g_previous_frame_time = 0;
+
+// ––––– FRAME-TIME HARNESS ––––– //
+// main.cpp --scenario name|all [--clock virtual|wall] [--budget-scale factor]
+std::vector<const Scenario*> g_scenarios;
+int g_scenario_index = 0;
+bool g_use_virtual_clock = true;
+float g_budget_scale = 1.0f;
+int g_failed_scenario_count = 0;
+uint64_t g_frame_deadline = 0;          // wall clock pacing, in Profiler::now() nanoseconds
+
+InputScript g_input_script;
+FrameTimings g_frame_timings;
+
+// ––––– INPUT RECORDING ––––– //
+// main.cpp --record file, or --replay file [--headless]
+InputRecording g_recording;
+InputRecording g_replay;
+const char* g_record_path = nullptr;
+const char* g_replay_path = nullptr;
+bool g_is_headless = false;             // no window or GL at all; replays run as fast as they can
+bool g_replay_failed = false;
+
+// ––––– HARDWARE COUNTERS ––––– //
+// main.cpp --perf [--perf-csv file], Linux only
+bool g_perf_enabled = false;
+const char* g_perf_csv_path = nullptr;
+int g_perf_first_frame = 0;             // of the running scenario, past its warm-up
 
 // ———— GENERAL FUNCTIONS ———— //
-GLuint load_texture(const char* filepath);
+GLuint load_texture(const char* filepath, CollisionMask* mask = nullptr);
+GLuint upload_texture(const unsigned char* rgba, int width, int height);
+void build_world_masks();
 
+bool parse_arguments(int argc, char* argv[]);
 void initialise();
+void initialise_display();
+void load_level();
+bool poll_event(SDL_Event* event);
 void process_input();
 void update();
+void step_simulation();
+void process_contacts();
+void restart_level();
+void rewind_level(int ticks);
+void resume_clock();
 void render();
+void publish_telemetry();
+void start_scenario();
+void finish_scenario();
+bool check_budget(const char* name, const char* measure, double value, float budget);
+void pace_frame();
+uint8_t input_bits(const Entity* player);
+bool replay_step();
+void run_headless_replay();
+void finish_replay();
+BatchOutcome level_outcome();
+uint64_t state_checksum();
+void load_in_background(uint64_t frame_start);
+void account_memory();
+void log_memory_report();
 void shutdown();
 
 // ––––– GENERAL FUNCTIONS ––––– //
-GLuint load_texture(const char* filepath) {
+GLuint load_texture(const char* filepath, CollisionMask* mask) {
+    STARTUP_SCOPE(filepath);
+    MEMORY_SCOPE(MEMORY_TEXTURES);
     int width, height, number_of_components;
     unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
     
     if (image == NULL) {
-        LOG("Unable to load image. Make sure the path is correct.");
+        LOG_ERROR("Unable to load image %s. Make sure the path is correct.", filepath);
+        g_logger.flush();
         assert(false);
     }
     
+    // The pixels are only on the CPU until they are freed below, so this is the time to keep their alpha
+    if (mask != nullptr) {
+        MEMORY_SCOPE(MEMORY_COLLISION);
+        mask->build(image, width, height);
+    }
+    
+    // Headless, the masks are all there is to keep
+    if (g_is_headless) {
+        stbi_image_free(image);
+        return 0;
+    }
+    
+    GLuint textureID = upload_texture(image, width, height);
+    stbi_image_free(image);
+    
+    return textureID;
+}
+
+// Main thread only; load_texture and the texture loader both come through here
+GLuint upload_texture(const unsigned char* rgba, int width, int height) {
     GLuint textureID;
     glGenTextures(NUMBER_OF_TEXTURES, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image);
+    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    g_memory.add_gpu_bytes(MEMORY_TEXTURES, (uint64_t)width * height * 4);     // RGBA8, no mipmaps
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -117,21 +288,143 @@ GLuint load_texture(const char* filepath) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     
-    stbi_image_free(image);
-    
     return textureID;
 }
 
+// Anything else is left alone: macOS hands apps arguments of its own (-NSDocumentRevisionsDebugMode, -psn_...)
+bool parse_arguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strncmp(option, "--", 2) != 0) continue;
+        
+        if (!strcmp(option, "--headless")) {
+            g_is_headless = true;
+            continue;
+        }
+        
+        if (!strcmp(option, "--perf")) {
+            g_perf_enabled = true;
+            continue;
+        }
+        
+        if (value == nullptr) { return false; }
+        i++;
+        
+        if (!strcmp(option, "--scenario")) {
+            size_t scenario_count = g_scenarios.size();
+            for (const Scenario& scenario : SCENARIOS) {
+                if (!strcmp(value, "all") || !strcmp(value, scenario.m_name)) g_scenarios.push_back(&scenario);
+            }
+            if (g_scenarios.size() == scenario_count) { return false; }
+        } else if (!strcmp(option, "--clock")) {
+            if (!strcmp(value, "virtual")) g_use_virtual_clock = true;
+            else if (!strcmp(value, "wall")) g_use_virtual_clock = false;
+            else return false;
+        } else if (!strcmp(option, "--budget-scale")) {
+            g_budget_scale = (float)atof(value);
+        } else if (!strcmp(option, "--record")) {
+            g_record_path = value;
+        } else if (!strcmp(option, "--replay")) {
+            g_replay_path = value;
+        } else if (!strcmp(option, "--perf-csv")) {
+            g_perf_csv_path = value;
+            g_perf_enabled = true;
+        } else {
+            return false;
+        }
+    }
+    
+    // A replay brings its own input, and only a replay can do without a window
+    if (g_replay_path != nullptr && (g_record_path != nullptr || !g_scenarios.empty())) { return false; }
+    if (g_is_headless && g_replay_path == nullptr) { return false; }
+    return g_budget_scale > 0.0f;
+}
+
 void initialise() {
+    {
+        STARTUP_SCOPE("logger");
+        g_logger.start();
+    }
+    
+    if (!g_is_headless) initialise_display();
+    
+    // ––––– TELEMETRY ––––– //
+    {
+        STARTUP_SCOPE("telemetry");
+        if (g_telemetry.open()) LOG_INFO("Publishing telemetry at %s", g_telemetry.get_name());
+        else LOG_WARNING("Unable to publish telemetry");
+    }
+    
+    // ––––– PROFILING ––––– //
+    g_profiler.set_thread_name("Main thread");
+    g_profiler.start_ring(PROFILE_SECONDS);
+    
+    // ––––– WORKERS ––––– //
+    {
+        STARTUP_SCOPE("workers");
+        g_job_system.initialise();
+        g_physics_world.set_job_system(&g_job_system);
+    }
+    
+    // ––––– TEXTURES ––––– //
+    // The end screens are only needed at the end; headless, they are never loaded at all
+    {
+        STARTUP_SCOPE("textures");
+        g_textures.bg = load_texture(BG_FILEPATH);
+        g_textures.win = g_texture_loader.defer(WIN_FILEPATH);
+        g_textures.lose = g_texture_loader.defer(LOSE_FILEPATH);
+        g_textures.nofuel = g_texture_loader.defer(NOFUEL_FILEPATH);
+        g_textures.pc = load_texture(PC_FILEPATH, &g_masks.pc);
+        g_textures.shroom = load_texture(SHROOM_FILEPATH, &g_masks.shroom);
+        g_textures.player = load_texture(SPRITESHEET_FILEPATH, &g_masks.player);
+        g_texture_loader.initialise(upload_texture);
+    }
+    
+    {
+        STARTUP_SCOPE("collision masks");
+        build_world_masks();
+    }
+    
+    // ––––– TERRAIN ––––– //
+    // Outlives level reloads, so it is built once and not in the level arena
+    {
+        STARTUP_SCOPE("terrain");
+        g_terrain.generate(TERRAIN_LEFT, TERRAIN_RIGHT, TERRAIN_COLUMNS, TERRAIN_BASE, TERRAIN_ROUGHNESS,
+                           TERRAIN_FLOOR, LEVEL_PADS, PAD_COUNT);
+        if (!g_is_headless) g_terrain.upload();
+    }
+    
+    {
+        STARTUP_SCOPE("level");
+        load_level();
+    }
+    
+    // ––––– INPUT RECORDING ––––– //
+    if (g_replay_path != nullptr) {
+        LOG_INFO("Replaying %s: %llu steps in %d runs", g_replay_path, (unsigned long long)g_replay.get_step_count(), g_replay.get_run_count());
+        g_replay.start_playback();
+    }
+    
+    // Started last so loading does not count as time to catch up on
+    g_frame_clock.start(FIXED_STEP_RATE, MAX_CATCH_UP_STEPS);
+}
+
+// The window, the GL context and everything drawn with it
+void initialise_display() {
+    STARTUP_SCOPE("display");
     SDL_Init(SDL_INIT_VIDEO);
+    
+    // Scenarios run unattended, on a build box as often as not
+    Uint32 window_flags = SDL_WINDOW_OPENGL | (g_scenarios.empty() ? 0 : SDL_WINDOW_HIDDEN);
     g_display_window = SDL_CreateWindow("Project 3: Lunar Lander", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                        WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_OPENGL);
+                                        WINDOW_WIDTH, WINDOW_HEIGHT, window_flags);
 
     SDL_GLContext context = SDL_GL_CreateContext(g_display_window);
     SDL_GL_MakeCurrent(g_display_window, context);
 
     if (context == nullptr) {
-        LOG("ERROR: Could not create OpenGL context.\n");
+        LOG_ERROR("Could not create OpenGL context: %s", SDL_GetError());
         shutdown();
     }
 
@@ -141,6 +434,7 @@ void initialise() {
 
     glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
 
+    STARTUP_SCOPE("shaders");
     g_shader_program.load(V_SHADER_PATH, F_SHADER_PATH);
 
     g_view_matrix = glm::mat4(1.0f);
@@ -149,99 +443,102 @@ void initialise() {
     g_shader_program.set_projection_matrix(g_projection_matrix);
     g_shader_program.set_view_matrix(g_view_matrix);
 
+    g_terrain_program.load(TERRAIN_V_SHADER_PATH, TERRAIN_F_SHADER_PATH);
+    g_terrain_program.set_projection_matrix(g_projection_matrix);
+    g_terrain_program.set_view_matrix(g_view_matrix);
+
     glUseProgram(g_shader_program.get_program_id());
 
     glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
     
+    // ––––– FRAME-TIME HARNESS ––––– //
+    // Without vsync a frame takes as long as its work does, which is what is being measured
+    if (!g_scenarios.empty()) {
+        SDL_GL_SetSwapInterval(0);
+        g_frame_timings.initialise();
+        if (!g_frame_timings.is_gpu_supported()) LOG_WARNING("No GL timer queries; scenarios will report CPU times only");
+    }
+    
+    // ––––– GENERAL ––––– //
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void build_world_masks() {
+    MEMORY_SCOPE(MEMORY_COLLISION);
+    for (int i = 0; i < PLATFORM_COUNT; i++) {
+        const PlatformLayout& layout = LEVEL_PLATFORMS[i];
+        const CollisionMask& source = layout.m_type == PC ? g_masks.pc : g_masks.shroom;
+        g_masks.platforms[i] = source.resample_to_world(0, 0, source.get_width(), source.get_height(),
+                                                        layout.m_sprite_width, layout.m_sprite_height);
+    }
+    
+    int frame_width = g_masks.player.get_width() / PLAYER_SHEET_COLS,
+        frame_height = g_masks.player.get_height() / PLAYER_SHEET_ROWS;
+    
+    for (int frame = 0; frame < PLAYER_SHEET_COLS * PLAYER_SHEET_ROWS; frame++) {
+        g_masks.player_frames[frame] = g_masks.player.resample_to_world((frame % PLAYER_SHEET_COLS) * frame_width,
+                                                                        (frame / PLAYER_SHEET_COLS) * frame_height,
+                                                                        frame_width, frame_height,
+                                                                        PLAYER_SPRITE_SIZE, PLAYER_SPRITE_SIZE);
+    }
+}
+
+// Builds every entity of the level inside the level arena; calling it again throws the previous
+// level away in one go instead of freeing entities one by one.
+void load_level() {
+    MEMORY_SCOPE(MEMORY_LEVEL);
+    g_level_arena.reset();
+    g_game_state = GameState();
+    g_progress = g_level_arena.create<LevelProgress>();
+    
     // ––––– BACKGROUND ––––– //
-    GLuint bg_texture_id = load_texture(BG_FILEPATH);
-    g_game_state.bg = new Entity();
-    g_game_state.bg->m_texture_id = bg_texture_id;
+    g_game_state.bg = g_level_arena.create<Entity>();
+    g_game_state.bg->m_texture_id = g_textures.bg;
     g_game_state.bg->set_position(glm::vec3(0.0f, 0.0f, 0.0f));
     g_game_state.bg->set_size(glm::vec3(16.89f, 9.75f, 0.0f));
     
     // ––––– WIN/LOSE/NOFUEL ––––– //
-    GLuint win_texture_id = load_texture(WIN_FILEPATH);
-    g_game_state.win = new Entity();
-    g_game_state.win->m_texture_id = win_texture_id;
+    g_game_state.win = g_level_arena.create<Entity>();
+    g_game_state.win->m_texture_id = g_texture_loader.get_texture_id(g_textures.win);
     g_game_state.win->set_position(glm::vec3(0.0f, 0.0f, 0.0f));
     g_game_state.win->m_model_matrix = glm::scale(g_game_state.win->m_model_matrix, glm::vec3(5.0f, 3.0f, 0.0f));
     g_game_state.win->set_entity_type(WIN);
     g_game_state.win->deactivate();
     
-    GLuint lose_texture_id = load_texture(LOSE_FILEPATH);
-    g_game_state.lose = new Entity();
-    g_game_state.lose->m_texture_id = lose_texture_id;
+    g_game_state.lose = g_level_arena.create<Entity>();
+    g_game_state.lose->m_texture_id = g_texture_loader.get_texture_id(g_textures.lose);
     g_game_state.lose->set_position(glm::vec3(0.0f, 0.0f, 0.0f));
     g_game_state.lose->m_model_matrix = glm::scale(g_game_state.lose->m_model_matrix, glm::vec3(5.0f, 3.0f, 0.0f));
     g_game_state.lose->set_entity_type(LOSE);
     g_game_state.lose->deactivate();
     
-    GLuint nofuel_texture_id = load_texture(NOFUEL_FILEPATH);
-    g_game_state.nofuel = new Entity();
-    g_game_state.nofuel->m_texture_id = nofuel_texture_id;
+    g_game_state.nofuel = g_level_arena.create<Entity>();
+    g_game_state.nofuel->m_texture_id = g_texture_loader.get_texture_id(g_textures.nofuel);
     g_game_state.nofuel->set_position(glm::vec3(0.0f, 0.0f, 0.0f));
     g_game_state.nofuel->m_model_matrix = glm::scale(g_game_state.nofuel->m_model_matrix, glm::vec3(5.39f, 1.82f, 0.0f));
     g_game_state.nofuel->set_entity_type(NOFUEL);
     g_game_state.nofuel->deactivate();
     
     // ––––– PLATFORMS ––––– //
-    GLuint pc_texture_id = load_texture(PC_FILEPATH);
-    GLuint shroom_texture_id = load_texture(SHROOM_FILEPATH);
-    
-    g_game_state.platforms = new Entity[PLATFORM_COUNT];
-    
-    // ––––– SHROOMS ––––– //
-    g_game_state.platforms[0].m_texture_id = shroom_texture_id;
-    g_game_state.platforms[0].set_position(glm::vec3(-3.5f, -1.75f, 0.0f));
-    g_game_state.platforms[0].set_width(0.0f);
-    g_game_state.platforms[0].set_height(0.5f);
-    g_game_state.platforms[0].set_entity_type(SHROOM);
-    g_game_state.platforms[0].update(0.0f, NULL, 0, g_win, g_lose, g_nofuel);
-    g_game_state.platforms[0].set_size(glm::vec3(0.765f, 0.765f, 0.0f));
+    g_game_state.platforms = g_level_arena.create_array<Entity>(PLATFORM_COUNT);
+    
+    for (int i = 0; i < PLATFORM_COUNT; i++) {
+        const PlatformLayout& layout = LEVEL_PLATFORMS[i];
+        Entity& platform = g_game_state.platforms[i];
+        
+        platform.m_texture_id = layout.m_type == PC ? g_textures.pc : g_textures.shroom;
+        platform.set_position(glm::vec3(layout.m_x, layout.m_y, 0.0f));
+        platform.set_width(layout.m_width);
+        platform.set_height(layout.m_height);
+        platform.set_entity_type(layout.m_type);
+        platform.update_model_matrix();
+        platform.set_size(glm::vec3(layout.m_sprite_width, layout.m_sprite_height, 0.0f));
         
-    g_game_state.platforms[1].m_texture_id = shroom_texture_id;
-    g_game_state.platforms[1].set_position(glm::vec3(3.5f, -1.75f, 0.0f));
-    g_game_state.platforms[1].set_width(0.0f);
-    g_game_state.platforms[1].set_height(0.5f);
-    g_game_state.platforms[1].set_entity_type(SHROOM);
-    g_game_state.platforms[1].update(0.0f, NULL, 0, g_win, g_lose, g_nofuel);
-    g_game_state.platforms[1].set_size(glm::vec3(0.765f, 0.765f, 0.0f));
-    
-    g_game_state.platforms[2].m_texture_id = shroom_texture_id;
-    g_game_state.platforms[2].set_position(glm::vec3(0.0f, -1.75f, 0.0f));
-    g_game_state.platforms[2].set_width(0.0f);
-    g_game_state.platforms[2].set_height(0.5f);
-    g_game_state.platforms[2].set_entity_type(SHROOM);
-    g_game_state.platforms[2].update(0.0f, NULL, 0, g_win, g_lose, g_nofuel);
-    g_game_state.platforms[2].set_size(glm::vec3(0.765f, 0.765f, 0.0f));
-    
-    // ––––– PCS ––––– //
-    g_game_state.platforms[3].m_texture_id = pc_texture_id;
-    g_game_state.platforms[3].set_position(glm::vec3(-1.95f, -3.15f, 0.0f));
-    g_game_state.platforms[3].set_width(0.25f);
-    g_game_state.platforms[3].set_height(1.0f);
-    g_game_state.platforms[3].set_entity_type(PC);
-    g_game_state.platforms[3].update(0.0f, NULL, 0, g_win, g_lose, g_nofuel);
-    g_game_state.platforms[3].set_size(glm::vec3(1.128f, 1.114f, 0.0f));
-    
-    g_game_state.platforms[4].m_texture_id = pc_texture_id;
-    g_game_state.platforms[4].set_position(glm::vec3(1.95f, -3.15f, 0.0f));
-    g_game_state.platforms[4].set_width(0.25f);
-    g_game_state.platforms[4].set_height(1.0f);
-    g_game_state.platforms[4].set_entity_type(PC);
-    g_game_state.platforms[4].update(0.0f, NULL, 0, g_win, g_lose, g_nofuel);
-    g_game_state.platforms[4].set_size(glm::vec3(1.128f, 1.114f, 0.0f));
+        if (PRECISE_COLLISION) platform.set_collision_masks(&g_masks.platforms[i], 1);
+    }
     
     // ————— PLAYER ————— //
-    GLuint player_texture_id = load_texture(SPRITESHEET_FILEPATH);
-    g_game_state.player = new Entity();
-    g_game_state.player->set_position(glm::vec3(0.0f, 0.0f, 0.0f));
-    g_game_state.player->set_movement(glm::vec3(0.0f, 0.0f, 0.0f));
-    g_game_state.player->set_entity_type(PLAYER);
-    g_game_state.player->m_speed = 5.0f;
-    g_game_state.player->set_acceleration(glm::vec3(0.0f, -3.0f, 0.0f));
-    
     int player_walking_animation[4][4] = {
         { 4, 5, 6, 7 },         // left
         { 8, 9, 10, 11 },       // right
@@ -249,37 +546,73 @@ void initialise() {
         { 12, 13, 14, 15 }      // downwards
     };
     
-    glm::vec3 acceleration = glm::vec3(0.0f, -4.905f, 0.0f);
+    glm::vec3 acceleration = glm::vec3(0.0f, PLAYER_GRAVITY, 0.0f);
 
-    g_game_state.player = new Entity(
-        player_texture_id,         // texture id
-        3.0f,                      // speed
+    g_game_state.player = g_level_arena.create<Entity>(
+        g_textures.player,         // texture id
+        PLAYER_SPEED,              // speed
         acceleration,              // acceleration
-        3.0f,                      // jumping power
+        PLAYER_JUMPING_POWER,      // jumping power
         player_walking_animation,  // animation index sets
         0.0f,                      // animation time
         4,                         // animation frame amount
         0,                         // current animation index
         4,                         // animation column amount
         4,                         // animation row amount
-        0.9f,                      // width
-        0.9f                       // height
+        PLAYER_WIDTH,              // width
+        PLAYER_HEIGHT              // height
     );
+    g_game_state.player->set_position(glm::vec3(PLAYER_START_X, PLAYER_START_Y, 0.0f));
+    g_game_state.player->set_fuel(PLAYER_FUEL);
+    g_game_state.player->set_entity_type(PLAYER);
+    
+    if (PRECISE_COLLISION) {
+        g_game_state.player->set_collision_masks(g_masks.player_frames, PLAYER_SHEET_COLS * PLAYER_SHEET_ROWS);
+    }
+    
+    // ————— PHYSICS ————— //
+    // Only the player moves; platforms and terrain are colliders and never get stepped
+    g_physics_world.clear();
+    g_physics_world.set_colliders(g_game_state.platforms, PLATFORM_COUNT);
+    g_physics_world.set_terrain(&g_terrain);
     
+    g_gravity.clear();
+    g_gravity.set_gravitational_constant(GRAVITATIONAL_CONSTANT);
+    for (int i = 0; i < ATTRACTOR_COUNT; i++) {
+        const AttractorLayout& layout = LEVEL_ATTRACTORS[i];
+        g_gravity.add_source(glm::vec2(layout.m_x, layout.m_y), layout.m_mass);
+    }
+    g_physics_world.set_gravity(&g_gravity);
+    g_physics_world.add_body(g_game_state.player);
+    
+    // ————— SNAPSHOTS ————— //
+    // Must come last: anything allocated after this is not part of the snapshots
+    g_snapshots.prepare(g_level_arena);
 
 //    // Jumping
 //    g_game_state.player->set_jumping_power(3.0f);
+}
+
+// While a scenario or a replay plays, the window's own events are still drained (so the OS does
+// not think it hung) but only quitting gets through; the keys come from the script or recording
+bool poll_event(SDL_Event* event) {
+    if (!g_input_script.is_playing() && !g_replay.is_playing()) { return SDL_PollEvent(event); }
     
-    // ––––– GENERAL ––––– //
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    while (SDL_PollEvent(event)) {
+        if (event->type == SDL_QUIT) { return true; }
+    }
+    return g_input_script.poll_event(event);
 }
 
 void process_input() {
+    PROFILE_FUNCTION();
+    PERF_SCOPE(PERF_INPUT);
     g_game_state.player->set_movement(glm::vec3(0.0f, 0.0f, 0.0f));
     
+    if (g_input_script.is_playing()) g_input_script.begin_frame();
+    
     SDL_Event event;
-    while (SDL_PollEvent(&event)) {
+    while (poll_event(&event)) {
         switch (event.type) {
             // End game
             case SDL_QUIT:
@@ -294,6 +627,27 @@ void process_input() {
                         g_game_is_running = false;
                         break;
                         
+                    case SDLK_r:
+                        // Back to the start, without reloading anything
+                        restart_level();
+                        break;
+                        
+                    case SDLK_b:
+                        // Rewind a little and try again from there
+                        rewind_level(REWIND_TICKS);
+                        break;
+                        
+                    case SDLK_p:
+                        // Dump the last few seconds of profiling zones for ui.perfetto.dev
+                        if (g_profiler.write_chrome_trace(PROFILE_FILEPATH)) LOG_INFO("Profile written to %s", PROFILE_FILEPATH);
+                        else LOG_WARNING("Unable to write %s", PROFILE_FILEPATH);
+                        break;
+                        
+                    case SDLK_m:
+                        // Where the memory is, by subsystem
+                        log_memory_report();
+                        break;
+                        
                     case SDLK_SPACE:
                         // Jump
                         if (g_game_state.player->get_collided_bottom())
@@ -309,7 +663,9 @@ void process_input() {
         }
     }
     
-    const Uint8* key_state = SDL_GetKeyboardState(NULL);
+    if (g_replay.is_playing()) { return; }
+    
+    const Uint8* key_state = g_input_script.is_playing() ? g_input_script.get_keyboard_state() : SDL_GetKeyboardState(NULL);
 
     if (key_state[SDL_SCANCODE_LEFT]) g_game_state.player->move_left();
     else if (key_state[SDL_SCANCODE_RIGHT]) g_game_state.player->move_right();
@@ -318,70 +674,475 @@ void process_input() {
 }
 
 void update() {
-    float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
-    float delta_time = ticks - g_previous_ticks;
-    g_previous_ticks = ticks;
-    
-    delta_time += g_accumulator;
+    PROFILE_FUNCTION();
+    // The virtual clock makes every scripted frame exactly one step, however long it really took
+    int steps = g_input_script.is_playing() && g_use_virtual_clock ? g_frame_clock.advance_by(g_input_script.get_frame_nanoseconds())
+                                                                   : g_frame_clock.advance();
+    if (steps == 0) { return; }
     
-    if (delta_time < FIXED_TIMESTEP) {
-        g_accumulator = delta_time;
-        return;
+    uint64_t step_start = Profiler::now();
+    {
+        PERF_SCOPE(PERF_PHYSICS);
+        for (int i = 0; i < steps; i++) {
+            if (!g_replay.is_playing()) step_simulation();
+            else if (!replay_step()) break;
+        }
     }
     
-    while (delta_time >= FIXED_TIMESTEP) {
-        g_game_state.player->update(FIXED_TIMESTEP, g_game_state.platforms, PLATFORM_COUNT, g_win, g_lose, g_nofuel);
-        delta_time -= FIXED_TIMESTEP;
-    }
+    g_telemetry_sample.m_steps = steps;
+    g_telemetry_sample.m_step_nanoseconds = (Profiler::now() - step_start) / steps;
     
-    g_accumulator = delta_time;
+    if (g_progress->win) { g_game_state.win->activate(); }
+    if (g_progress->lose) { g_game_state.lose->activate(); }
+    if (g_progress->nofuel) { g_game_state.nofuel->activate(); }
     
-    if (g_win) { g_game_state.win->activate(); }
-    if (g_lose) { g_game_state.lose->activate(); }
-    if (g_nofuel) { g_game_state.nofuel->activate(); }
+}
+
+// One fixed step of the level. The simulation only ever changes here and in restart_level() and
+// rewind_level(), which is what lets a recording of those three replay a session exactly.
+void step_simulation() {
+    if (g_record_path != nullptr) g_recording.record_step(input_bits(g_game_state.player));
     
+    g_physics_world.step(FIXED_TIMESTEP, g_contacts);
+    g_telemetry_sample.m_pairs_tested += g_contacts.get_pairs_tested();
+    process_contacts();
+    g_progress->tick++;
+    g_snapshots.push(g_level_arena);
+}
+
+// Gameplay reactions to whatever the last step's collision pass reported
+void process_contacts() {
+    for (const ContactEvent& event : g_contacts) {
+        if (event.m_type == OUT_OF_FUEL) {
+            g_progress->nofuel = true;
+        } else if (event.m_other_type == SHROOM || event.m_other_type == TERRAIN) {
+            g_progress->lose = true;
+        } else if (event.m_other_type == PC || event.m_other_type == LANDING_PAD) {
+            g_progress->win = true;
+        }
+    }
+    
+    g_contacts.clear();
+}
+
+void restart_level() {
+    if (g_record_path != nullptr) g_recording.record_restart();
+    if (g_snapshots.restart(g_level_arena)) resume_clock();
+}
+
+void rewind_level(int ticks) {
+    if (g_record_path != nullptr) g_recording.record_rewind(ticks);
+    if (g_snapshots.rewind(g_level_arena, ticks)) resume_clock();
+}
+
+// The simulation did not run while we were away (or stopped on a win/lose), so don't let
+// update() try to catch up on that time
+void resume_clock() {
+    g_frame_clock.reset();
+    g_contacts.clear();
 }
 
 void render() {
+    PROFILE_FUNCTION();
+    PERF_SCOPE(PERF_RENDER);
+    g_shader_program.reset_draw_call_count();
+    g_terrain_program.reset_draw_call_count();
+    
+    g_frame_timings.begin_gpu();
     glClear(GL_COLOR_BUFFER_BIT);
     
     g_game_state.bg->render(&g_shader_program);
+    g_terrain.render(&g_terrain_program);
     g_game_state.player->render(&g_shader_program);
     
     for (int i = 0; i < PLATFORM_COUNT; i++) g_game_state.platforms[i].render(&g_shader_program);
     
-    if (g_win) {
+    // The end screens may still be on their way; require() has them ready, waiting if it must
+    if (g_progress->win) {
+        g_game_state.win->m_texture_id = g_texture_loader.require(g_textures.win);
         g_game_state.win->render(&g_shader_program);
-    } else if (g_lose) {
+    } else if (g_progress->lose) {
+        g_game_state.lose->m_texture_id = g_texture_loader.require(g_textures.lose);
         g_game_state.lose->render(&g_shader_program);
     }
     
-    if (g_nofuel) {
+    if (g_progress->nofuel) {
+        g_game_state.nofuel->m_texture_id = g_texture_loader.require(g_textures.nofuel);
         g_game_state.nofuel->render(&g_shader_program);
     }
     
+    g_telemetry_sample.m_draw_calls = g_shader_program.get_draw_call_count() + g_terrain_program.get_draw_call_count();
+    g_frame_timings.end_gpu();
+    
+    PROFILE_SCOPE("SDL_GL_SwapWindow");
+    PERF_SCOPE(PERF_SWAP);
     SDL_GL_SwapWindow(g_display_window);
 }
 
+// Once per frame; readers in other processes pick it up whenever they like
+void publish_telemetry() {
+    TelemetrySample& sample = g_telemetry_sample;
+    uint64_t time = Profiler::now();
+    
+    sample.m_frame++;
+    sample.m_frame_nanoseconds = g_previous_frame_time != 0 ? time - g_previous_frame_time : 0;
+    g_previous_frame_time = time;
+    
+    sample.m_tick = g_progress->tick;
+    sample.m_dropped_steps = g_frame_clock.get_dropped_steps();
+    sample.m_fuel = g_game_state.player->get_fuel();
+    
+    glm::vec3 feet = g_game_state.player->get_position() - glm::vec3(0.0f, g_game_state.player->get_height() / 2.0f, 0.0f);
+    sample.m_altitude = g_physics_world.get_query().altitude(feet);
+    
+    sample.m_body_count = g_physics_world.get_body_count();
+    sample.m_awake_count = g_physics_world.get_awake_count();
+    sample.m_collider_count = g_physics_world.get_collider_count();
+    sample.m_sleeping_count = g_physics_world.get_sleeping_count();
+    
+    sample.m_arena_allocations = g_level_arena.get_allocation_count();
+    sample.m_arena_blocks = g_level_arena.get_block_count();
+    sample.m_arena_bytes = g_level_arena.get_bytes_used();
+    sample.m_arena_peak_bytes = g_level_arena.get_peak_bytes();
+    
+    MemoryTagStats memory = g_memory.get_total();
+    sample.m_heap_bytes = memory.m_live_bytes;
+    sample.m_heap_peak_bytes = memory.m_peak_bytes;
+    sample.m_heap_allocations = (uint32_t)memory.m_live_allocations;
+    sample.m_gpu_bytes = memory.m_gpu_bytes;
+    sample.m_frame_allocations = memory.m_frame_allocations;
+    sample.m_frame_allocation_bytes = memory.m_frame_bytes;
+    
+    sample.m_outcome = (g_progress->win ? OUTCOME_WIN : 0) | (g_progress->lose ? OUTCOME_LOSE : 0) | (g_progress->nofuel ? OUTCOME_NO_FUEL : 0);
+    
+    g_telemetry.publish(sample);
+    
+    // Per-frame counters start over; a frame without update() ran no steps
+    sample.m_steps = 0;
+    sample.m_pairs_tested = 0;
+    sample.m_step_nanoseconds = 0;
+}
+
+// ––––– STARTUP ––––– //
+// Once per frame, after the frame is presented. The first one lets the deferred textures start
+// loading; the startup report waits until they all have, so it shows them too.
+void load_in_background(uint64_t frame_start) {
+    if (!g_startup.has_first_frame()) {
+        g_startup.finish_first_frame(frame_start);
+        g_texture_loader.start();
+    }
+    
+    g_texture_loader.poll();
+    if (g_texture_loader.is_finished() && !g_startup.is_reported()) g_startup.report();
+}
+
+// ––––– MEMORY ––––– //
+// Once per frame: closes the frame's allocation counts and holds them against the budgets
+void account_memory() {
+    g_memory.end_frame();
+    
+    MemoryTag busiest = MEMORY_GENERAL,
+              over_budget = MEMORY_TAG_COUNT;
+    for (int i = 0; i < MEMORY_TAG_COUNT; i++) {
+        MemoryTag tag = (MemoryTag)i;
+        MemoryTagStats stats = g_memory.get_stats(tag);
+        
+        if (stats.m_frame_allocations > g_memory.get_stats(busiest).m_frame_allocations) busiest = tag;
+        if (over_budget == MEMORY_TAG_COUNT && stats.m_live_bytes > MEMORY_BUDGETS[tag]) over_budget = tag;
+    }
+    
+    if (over_budget != MEMORY_TAG_COUNT) {
+        LOG_EVERY(SEVERITY_WARNING, MEMORY_WARNING_SECONDS, "Memory: %s holds %llu KB, over its %llu KB budget",
+                  MemoryTracker::tag_name(over_budget), (unsigned long long)(g_memory.get_stats(over_budget).m_live_bytes / 1024),
+                  (unsigned long long)(MEMORY_BUDGETS[over_budget] / 1024));
+    }
+    
+    // Textures still loading in the background allocate by design
+    MemoryTagStats total = g_memory.get_total();
+    if (total.m_frame_allocations > FRAME_ALLOCATION_BUDGET && g_texture_loader.is_finished()) {
+        LOG_EVERY(SEVERITY_WARNING, MEMORY_WARNING_SECONDS, "Memory: %u allocations (%llu bytes) in one frame, most of them %s",
+                  total.m_frame_allocations, (unsigned long long)total.m_frame_bytes, MemoryTracker::tag_name(busiest));
+    }
+}
+
+void log_memory_report() {
+    LOG_INFO("Memory %-12s %10s %10s %8s %10s %10s", "tag", "live KB", "peak KB", "live", "allocs", "GPU KB");
+    for (int i = 0; i <= MEMORY_TAG_COUNT; i++) {
+        MemoryTagStats stats = i < MEMORY_TAG_COUNT ? g_memory.get_stats((MemoryTag)i) : g_memory.get_total();
+        if (stats.m_total_allocations == 0 && stats.m_gpu_peak_bytes == 0) continue;
+        
+        LOG_INFO("Memory %-12s %10.1f %10.1f %8llu %10llu %10.1f", i < MEMORY_TAG_COUNT ? MemoryTracker::tag_name((MemoryTag)i) : "total",
+                 stats.m_live_bytes / 1024.0, stats.m_peak_bytes / 1024.0, (unsigned long long)stats.m_live_allocations,
+                 (unsigned long long)stats.m_total_allocations, stats.m_gpu_bytes / 1024.0);
+    }
+}
+
+// ––––– FRAME-TIME HARNESS ––––– //
+// Every scenario starts from the level as loaded, whatever the one before left behind
+void start_scenario() {
+    const Scenario* scenario = g_scenarios[g_scenario_index];
+    
+    // An upload halfway through would be measured as a slow frame of the scenario's
+    g_texture_loader.require_all();
+    restart_level();
+    g_input_script.start(scenario);
+    g_frame_timings.clear();
+    g_perf_first_frame = g_perf.get_frame_count() + SCENARIO_WARM_UP_FRAMES;
+    
+    LOG_INFO("Scenario %s: %d frames on the %s clock", scenario->m_name, scenario->m_frame_count, g_use_virtual_clock ? "virtual" : "wall");
+}
+
+void finish_scenario() {
+    const Scenario& scenario = *g_input_script.get_scenario();
+    g_frame_timings.finish();
+    
+    BatchOutcome outcome = level_outcome();
+    FrameTimeSummary cpu = g_frame_timings.summarise_cpu(SCENARIO_WARM_UP_FRAMES),
+                     gpu = g_frame_timings.summarise_gpu(SCENARIO_WARM_UP_FRAMES);
+    
+    LOG_INFO("Scenario %s: %s after %d ticks; cpu ms p50 %.3f p99 %.3f max %.3f over %d frames", scenario.m_name,
+             OUTCOME_NAMES[outcome], g_progress->tick, cpu.m_p50_ms, cpu.m_p99_ms, cpu.m_max_ms, cpu.m_count);
+    if (g_frame_timings.is_gpu_supported()) {
+        LOG_INFO("Scenario %s: gpu ms p50 %.3f p99 %.3f max %.3f over %d frames", scenario.m_name,
+                 gpu.m_p50_ms, gpu.m_p99_ms, gpu.m_max_ms, gpu.m_count);
+    }
+    g_perf.log_summary(g_perf_first_frame);
+    
+    bool passed = true;
+    
+    // Only the virtual clock is deterministic; on the wall clock the steps fall differently every run
+    if (g_use_virtual_clock && outcome != scenario.m_expected_outcome) {
+        LOG_ERROR("Scenario %s: ended %s, expected %s", scenario.m_name, OUTCOME_NAMES[outcome], OUTCOME_NAMES[scenario.m_expected_outcome]);
+        passed = false;
+    }
+    
+    passed &= check_budget(scenario.m_name, "cpu p50", cpu.m_p50_ms, CPU_P50_BUDGET_MS);
+    passed &= check_budget(scenario.m_name, "cpu p99", cpu.m_p99_ms, CPU_P99_BUDGET_MS);
+    passed &= check_budget(scenario.m_name, "cpu max", cpu.m_max_ms, CPU_MAX_BUDGET_MS);
+    
+    if (g_frame_timings.is_gpu_supported()) {
+        passed &= check_budget(scenario.m_name, "gpu p50", gpu.m_p50_ms, GPU_P50_BUDGET_MS);
+        passed &= check_budget(scenario.m_name, "gpu p99", gpu.m_p99_ms, GPU_P99_BUDGET_MS);
+        passed &= check_budget(scenario.m_name, "gpu max", gpu.m_max_ms, GPU_MAX_BUDGET_MS);
+    }
+    
+    if (passed) {
+        LOG_INFO("Scenario %s: passed", scenario.m_name);
+    } else {
+        LOG_ERROR("Scenario %s: FAILED", scenario.m_name);
+        g_failed_scenario_count++;
+    }
+    
+    g_input_script.stop();
+    g_scenario_index++;
+    
+    if (g_scenario_index < (int)g_scenarios.size()) start_scenario();
+    else g_game_is_running = false;
+}
+
+bool check_budget(const char* name, const char* measure, double value, float budget) {
+    double limit = budget * g_budget_scale;
+    if (value <= limit) { return true; }
+    
+    LOG_ERROR("Scenario %s: %s of %.3f ms is over its %.3f ms budget", name, measure, value, limit);
+    return false;
+}
+
+// With vsync off a frame lasts as long as its work, so on the wall clock the script would be over
+// in a fraction of its real length; this sleeps out the rest of each frame the way a 60 Hz display would
+void pace_frame() {
+    uint64_t time = Profiler::now();
+    g_frame_deadline += g_input_script.get_frame_nanoseconds();
+    
+    // Far behind (the first frame, a stall): measure the next frame from now instead of rushing
+    if (g_frame_deadline + g_input_script.get_frame_nanoseconds() < time) g_frame_deadline = time;
+    else if (g_frame_deadline > time) SDL_Delay((Uint32)((g_frame_deadline - time) / 1000000));
+}
+
+// ––––– INPUT RECORDING ––––– //
+// What a step is fed: the movement process_input() left and the way the sprite faces
+uint8_t input_bits(const Entity* player) {
+    glm::vec3 movement = player->get_movement();
+    uint8_t actions = (movement.x < 0.0f ? ACTION_LEFT : 0) | (movement.x > 0.0f ? ACTION_RIGHT : 0) |
+                      (movement.y > 0.0f ? ACTION_UP : 0)   | (movement.y < 0.0f ? ACTION_DOWN : 0);
+    return actions | (uint8_t)(player->get_facing() << INPUT_FACING_SHIFT);
+}
+
+// Plays the recording up to and including its next step; false once it has run out
+bool replay_step() {
+    uint8_t bits;
+    uint32_t argument;
+    
+    while (g_replay.next(bits, argument)) {
+        if (bits & INPUT_RESTART) {
+            restart_level();
+        } else if (bits & INPUT_REWIND) {
+            rewind_level((int)argument);
+        } else {
+            Entity* player = g_game_state.player;
+            // The same calls process_input() makes, so the movement comes out bit for bit the same;
+            // the facing goes last since the moves turn the sprite as well
+            player->set_movement(glm::vec3(0.0f));
+            if (bits & ACTION_LEFT) player->move_left();
+            else if (bits & ACTION_RIGHT) player->move_right();
+            if (bits & ACTION_UP) player->move_up();
+            else if (bits & ACTION_DOWN) player->move_down();
+            if (glm::length(player->get_movement()) > 1.0f) player->normalise_movement();
+            player->face((AnimationDirection)((bits & INPUT_FACING_MASK) >> INPUT_FACING_SHIFT));
+            
+            step_simulation();
+            return true;
+        }
+    }
+    
+    finish_replay();
+    return false;
+}
+
+// No window, no frame clock, no rendering: just the steps, back to back
+void run_headless_replay() {
+    uint64_t start = Profiler::now();
+    uint64_t steps = 0;
+    while (true) {
+        {
+            PERF_SCOPE(PERF_PHYSICS);
+            if (!replay_step()) break;
+        }
+        steps++;
+        g_perf.end_frame();                 // with no frames, each step counts as one
+    }
+    
+    double seconds = (Profiler::now() - start) / 1e9,
+           played_seconds = (double)steps / g_replay.get_step_rate();
+    LOG_INFO("Replayed %llu steps (%.1f s of play) in %.3f s, %.0fx real time", (unsigned long long)steps, played_seconds,
+             seconds, seconds > 0.0 ? played_seconds / seconds : 0.0);
+}
+
+void finish_replay() {
+    g_replay.stop_playback();
+    g_game_is_running = false;
+    
+    BatchOutcome outcome = level_outcome();
+    uint64_t checksum = state_checksum();
+    
+    if (outcome == g_replay.get_outcome() && checksum == g_replay.get_checksum()) {
+        LOG_INFO("Replay matches the recording: %s after %d ticks", OUTCOME_NAMES[outcome], g_progress->tick);
+    } else {
+        LOG_ERROR("Replay diverged: %s (state %016llx), recorded %s (state %016llx)", OUTCOME_NAMES[outcome],
+                  (unsigned long long)checksum, OUTCOME_NAMES[g_replay.get_outcome()], (unsigned long long)g_replay.get_checksum());
+        g_replay_failed = true;
+    }
+}
+
+BatchOutcome level_outcome() {
+    return g_progress->win    ? OUTCOME_WON
+         : g_progress->lose   ? OUTCOME_LOST
+         : g_progress->nofuel ? OUTCOME_OUT_OF_FUEL
+         : OUTCOME_RUNNING;
+}
+
+// What a replay has to reproduce bit for bit: how far the level got and where the lander is
+uint64_t state_checksum() {
+    const Entity* player = g_game_state.player;
+    int progress[] = { g_progress->tick, g_progress->win, g_progress->lose, g_progress->nofuel };
+    glm::vec3 position = player->get_position(),
+              velocity = player->get_velocity();
+    float fuel = player->get_fuel();
+    
+    uint64_t checksum = InputRecording::checksum(progress, sizeof(progress));
+    checksum = InputRecording::checksum(&position, sizeof(position), checksum);
+    checksum = InputRecording::checksum(&velocity, sizeof(velocity), checksum);
+    return InputRecording::checksum(&fuel, sizeof(fuel), checksum);
+}
+
 void shutdown() {
+    if (g_record_path != nullptr) {
+        g_recording.set_result(level_outcome(), state_checksum());
+        if (g_recording.save(g_record_path)) {
+            LOG_INFO("Recorded %llu steps in %d runs to %s", (unsigned long long)g_recording.get_step_count(),
+                     g_recording.get_run_count(), g_record_path);
+        } else {
+            LOG_WARNING("Unable to write %s", g_record_path);
+        }
+    }
+    
+    if (!g_is_headless) g_startup.report();
+    
+    if (g_perf.is_open()) {
+        g_perf.log_summary();
+        if (g_perf_csv_path != nullptr) {
+            if (g_perf.write_csv(g_perf_csv_path)) LOG_INFO("Counters for %d frames written to %s", g_perf.get_frame_count(), g_perf_csv_path);
+            else LOG_WARNING("Unable to write %s", g_perf_csv_path);
+        }
+        g_perf.close();
+    }
+    
+    g_texture_loader.shutdown();
+    g_job_system.shutdown();
+    g_terrain.release();
+    g_frame_timings.release();
     SDL_Quit();
     
-    delete [] g_game_state.platforms;
-    delete g_game_state.player;
+    LOG_INFO("Level arena: %d allocations, %zu peak bytes in %d block(s)", g_level_arena.get_total_allocation_count(),
+             g_level_arena.get_peak_bytes(), g_level_arena.get_block_count());
+    LOG_INFO("Frame clock: %llu steps, %llu dropped (%llu ms) in %llu capped frame(s)", (unsigned long long)g_frame_clock.get_step_count(),
+             (unsigned long long)g_frame_clock.get_dropped_steps(), (unsigned long long)(g_frame_clock.get_dropped_nanoseconds() / 1000000),
+             (unsigned long long)g_frame_clock.get_capped_frames());
+    log_memory_report();
+    
+    g_level_arena.reset();
+    g_game_state = GameState();
+    g_telemetry.close();
+    g_logger.shutdown();
 }
 
 // ––––– GAME LOOP ––––– //
 int main(int argc, char* argv[]) {
+    g_startup.start();
+    if (!parse_arguments(argc, argv)) {
+        fprintf(stderr, "usage: %s [--scenario name|all] [--clock virtual|wall] [--budget-scale factor]\n"
+                        "       %s [--record file | --replay file [--headless]]\n"
+                        "       either with [--perf] [--perf-csv file]\n", argv[0], argv[0]);
+        return 1;
+    }
+    
+    if (g_replay_path != nullptr && !g_replay.load(g_replay_path)) {
+        fprintf(stderr, "Unable to read the recording %s\n", g_replay_path);
+        return 1;
+    }
+    
     initialise();
+    if (!g_scenarios.empty()) start_scenario();
+    g_memory.end_frame();                   // loading is not the first frame's allocations
+    
+    // Counting starts with the first frame, on the thread that runs them
+    if (g_perf_enabled && g_perf.open()) LOG_INFO("Counting cycles, instructions and cache misses per phase");
+    if (g_is_headless) run_headless_replay();
     
     while (g_game_is_running) {
+        uint64_t frame_start = Profiler::now();
+        if (g_input_script.is_playing()) g_frame_timings.begin_frame();
         process_input();
         
-        if (g_win == 0 and g_lose == 0) {
+        // A replay carries on past a win or loss by itself, if the player restarted there
+        if (g_replay.is_playing() or (!g_progress->win and !g_progress->lose)) {
             update();
         }
         render();
+        load_in_background(frame_start);
+        account_memory();
+        publish_telemetry();
+        g_perf.end_frame();
+        
+        if (g_input_script.is_playing()) {
+            g_frame_timings.end_frame();
+            if (!g_use_virtual_clock) pace_frame();
+            if (g_input_script.is_finished()) finish_scenario();
+        }
     }
     shutdown();
-    return 0;
+    
+    // Closing the window halfway through a run does not count as passing it
+    bool harness_failed = g_failed_scenario_count > 0 || g_scenario_index < (int)g_scenarios.size();
+    return harness_failed || g_replay_failed ? 1 : 0;
 }
@@ -0,0 +1,224 @@
+/*
+* Batch equivalence check
+*
+* Flies every scripted scenario (Scenarios.h) through the game's own physics (Entity, PhysicsWorld,
+* Terrain, GravityField, built the way load_level() builds them) and through BatchSimulation side
+* by side, step by step, and reports where the two part ways: the largest position and velocity
+* difference, and the outcome and step each one ends on. Exits non-zero when any scenario differs
+* by more than the tolerance or ends differently.
+*
+* The game side uses the hand-tuned boxes without the pixel masks, like the batch does, so what
+* is compared is the physics the batch claims to mirror; the masks can only narrow the boxes.
+*
+* Build (from this directory, Linux with SDL2 and GL development packages):
+*   c++ -std=c++20 -O2 -pthread -DMEMORY_TRACKING_ENABLED=0 -I../lunarLander \
+*       $(sdl2-config --cflags) batch_equivalence.cpp ../lunarLander/BatchSimulation.cpp \
+*       ../lunarLander/Entity.cpp ../lunarLander/PhysicsWorld.cpp ../lunarLander/Terrain.cpp \
+*       ../lunarLander/GravityField.cpp ../lunarLander/SpatialQuery.cpp ../lunarLander/CollisionMask.cpp \
+*       ../lunarLander/ShaderProgram.cpp ../lunarLander/LevelArena.cpp ../lunarLander/JobSystem.cpp \
+*       ../lunarLander/Logger.cpp ../lunarLander/Profiler.cpp ../lunarLander/PerfCounters.cpp \
+*       ../lunarLander/MemoryTracker.cpp $(sdl2-config --libs) -lGL -o batch_equivalence
+*
+* Usage:
+*   batch_equivalence [--scenario name|all] [--tolerance units] [--verbose]
+*/
+
+#define GL_SILENCE_DEPRECATION
+#define GL_GLEXT_PROTOTYPES 1
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Entity.h"
+#include "ContactEvent.h"
+#include "PhysicsWorld.h"
+#include "Terrain.h"
+#include "GravityField.h"
+#include "BatchSimulation.h"
+#include "Scenarios.h"
+#include "Logger.h"
+
+// ––––– STRUCTS AND ENUMS ––––– //
+struct Comparison {
+    BatchOutcome m_game_outcome, m_batch_outcome;
+    int m_game_steps, m_batch_steps;
+    float m_position_error, m_velocity_error;   // largest over the steps both were still flying
+    int m_worst_step;                           // where the position difference was largest
+};
+
+// ––––– CONSTANTS ––––– //
+constexpr const char* OUTCOME_NAMES[] = { "running", "won", "lost", "out of fuel" };
+
+// ––––– GLOBAL VARIABLES ––––– //
+const char* g_scenario_name = "all";
+float g_tolerance = 1e-4f;
+bool g_verbose = false;
+
+// ––––– GENERAL FUNCTIONS ––––– //
+bool parse_arguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+
+        if (!strcmp(option, "--verbose")) { g_verbose = true; continue; }
+
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) { return false; }
+        i++;
+
+        if      (!strcmp(option, "--scenario"))  g_scenario_name = value;
+        else if (!strcmp(option, "--tolerance")) g_tolerance = (float)atof(value);
+        else return false;
+    }
+    return true;
+}
+
+// The BatchAction bits held on a scenario's frame, as InputScript presses them
+uint8_t scripted_actions(const Scenario& scenario, int frame) {
+    uint8_t actions = ACTION_NONE;
+    for (int i = 0; i < scenario.m_input_count; i++) {
+        const ScriptedInput& input = scenario.m_inputs[i];
+        if (frame >= input.m_first_frame && frame < input.m_first_frame + input.m_frame_count) actions |= input.m_actions;
+    }
+    return actions;
+}
+
+// The same calls the game makes for a step's input (see replay_step() in main.cpp)
+void apply_actions(Entity* player, uint8_t actions) {
+    player->set_movement(glm::vec3(0.0f));
+    if (actions & ACTION_LEFT) player->move_left();
+    else if (actions & ACTION_RIGHT) player->move_right();
+    if (actions & ACTION_UP) player->move_up();
+    else if (actions & ACTION_DOWN) player->move_down();
+    if (glm::length(player->get_movement()) > 1.0f) player->normalise_movement();
+}
+
+// process_contacts() in main.cpp, reduced to the outcome
+BatchOutcome contact_outcome(const ContactBuffer& contacts) {
+    bool won = false, lost = false, out_of_fuel = false;
+    for (const ContactEvent& event : contacts) {
+        if (event.m_type == OUT_OF_FUEL) out_of_fuel = true;
+        else if (event.m_other_type == SHROOM || event.m_other_type == TERRAIN) lost = true;
+        else if (event.m_other_type == PC || event.m_other_type == LANDING_PAD) won = true;
+    }
+    if (out_of_fuel) { return OUTCOME_OUT_OF_FUEL; }
+    if (lost) { return OUTCOME_LOST; }
+    return won ? OUTCOME_WON : OUTCOME_RUNNING;
+}
+
+Comparison compare(const Scenario& scenario, const Terrain& terrain) {
+    // ————— GAME ————— //
+    Entity platforms[PLATFORM_COUNT];
+    for (int i = 0; i < PLATFORM_COUNT; i++) {
+        const PlatformLayout& layout = LEVEL_PLATFORMS[i];
+        platforms[i].set_position(glm::vec3(layout.m_x, layout.m_y, 0.0f));
+        platforms[i].set_width(layout.m_width);
+        platforms[i].set_height(layout.m_height);
+        platforms[i].set_entity_type(layout.m_type);
+    }
+
+    int walking_animation[4][4] = { { 4, 5, 6, 7 }, { 8, 9, 10, 11 }, { 0, 1, 2, 3 }, { 12, 13, 14, 15 } };
+    Entity player(0, PLAYER_SPEED, glm::vec3(0.0f, PLAYER_GRAVITY, 0.0f), PLAYER_JUMPING_POWER, walking_animation,
+                  0.0f, 4, 0, 4, 4, PLAYER_WIDTH, PLAYER_HEIGHT);
+    player.set_position(glm::vec3(PLAYER_START_X, PLAYER_START_Y, 0.0f));
+    player.set_fuel(PLAYER_FUEL);
+    player.set_entity_type(PLAYER);
+
+    GravityField gravity;
+    gravity.set_gravitational_constant(GRAVITATIONAL_CONSTANT);
+    for (const AttractorLayout& layout : LEVEL_ATTRACTORS) gravity.add_source(glm::vec2(layout.m_x, layout.m_y), layout.m_mass);
+
+    PhysicsWorld world;
+    world.set_colliders(platforms, PLATFORM_COUNT);
+    world.set_terrain(&terrain);
+    world.set_gravity(&gravity);
+    world.add_body(&player);
+
+    // ————— BATCH ————— //
+    BatchSimulation batch(1);
+    float observation[BatchSimulation::OBSERVATION_SIZE], reward;
+    uint8_t done = 0;
+
+    Comparison result = { OUTCOME_RUNNING, OUTCOME_RUNNING, scenario.m_frame_count, scenario.m_frame_count, 0.0f, 0.0f, 0 };
+    ContactBuffer contacts;
+
+    // Every frame of a scenario is one step on the virtual clock. The game keeps stepping after an
+    // outcome; both are only compared up to the first one.
+    for (int frame = 0; frame < scenario.m_frame_count; frame++) {
+        uint8_t actions = scripted_actions(scenario, frame);
+
+        if (result.m_game_outcome == OUTCOME_RUNNING) {
+            apply_actions(&player, actions);
+            contacts.clear();
+            world.step(FIXED_TIMESTEP, contacts);
+            result.m_game_outcome = contact_outcome(contacts);
+            if (result.m_game_outcome != OUTCOME_RUNNING) result.m_game_steps = frame + 1;
+        }
+        if (!done) {
+            batch.step(&actions, observation, &reward, &done);
+            if (done) {
+                result.m_batch_outcome = batch.get_outcome(0);
+                result.m_batch_steps = batch.get_steps(0);
+            }
+        }
+
+        // Both have taken this step: the states should still agree
+        if (result.m_game_steps > frame && result.m_batch_steps > frame) {
+            glm::vec3 position = player.get_position(),
+                      velocity = player.get_velocity();
+            float position_error = fmaxf(fabsf(position.x - observation[0]), fabsf(position.y - observation[1])),
+                  velocity_error = fmaxf(fabsf(velocity.x - observation[2]), fabsf(velocity.y - observation[3]));
+
+            if (g_verbose) {
+                printf("%s %4d game (%9.5f, %9.5f) batch (%9.5f, %9.5f)\n", scenario.m_name, frame + 1,
+                       position.x, position.y, observation[0], observation[1]);
+            }
+            if (position_error > result.m_position_error) {
+                result.m_position_error = position_error;
+                result.m_worst_step = frame + 1;
+            }
+            result.m_velocity_error = fmaxf(result.m_velocity_error, velocity_error);
+        }
+
+        if (result.m_game_outcome != OUTCOME_RUNNING && done) break;
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parse_arguments(argc, argv)) {
+        fprintf(stderr, "usage: %s [--scenario name|all] [--tolerance units] [--verbose]\n", argv[0]);
+        return 1;
+    }
+
+    // The entities log their fuel as they fly; only problems are worth seeing here
+    g_logger.set_severity(SEVERITY_WARNING);
+
+    Terrain terrain;
+    terrain.generate(TERRAIN_LEFT, TERRAIN_RIGHT, TERRAIN_COLUMNS, TERRAIN_BASE, TERRAIN_ROUGHNESS, TERRAIN_FLOOR,
+                     LEVEL_PADS, PAD_COUNT);
+
+    int compared_count = 0,
+        failed_count = 0;
+
+    for (const Scenario& scenario : SCENARIOS) {
+        if (strcmp(g_scenario_name, "all") != 0 && strcmp(g_scenario_name, scenario.m_name) != 0) continue;
+        compared_count++;
+
+        Comparison result = compare(scenario, terrain);
+        bool same_ending = result.m_game_outcome == result.m_batch_outcome && result.m_game_steps == result.m_batch_steps;
+        bool passed = same_ending && result.m_position_error <= g_tolerance && result.m_velocity_error <= g_tolerance;
+        if (!passed) failed_count++;
+
+        printf("%-18s game %s after %d, batch %s after %d, max difference %.2e at step %d (velocity %.2e) ... %s\n",
+               scenario.m_name, OUTCOME_NAMES[result.m_game_outcome], result.m_game_steps,
+               OUTCOME_NAMES[result.m_batch_outcome], result.m_batch_steps, result.m_position_error,
+               result.m_worst_step, result.m_velocity_error, passed ? "passed" : "FAILED");
+    }
+
+    if (compared_count == 0) {
+        fprintf(stderr, "No scenario named %s.\n", g_scenario_name);
+        return 1;
+    }
+    return failed_count == 0 ? 0 : 1;
+}
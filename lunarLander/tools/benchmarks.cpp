@@ -0,0 +1,531 @@
+/*
+* Microbenchmarks
+*
+* Times the hot paths of the game outside of it: entity updates at growing entity and collider
+* counts, the collision tests and narrowphase passes, spatial queries (raycasts, overlaps, nearest
+* collider, altitude) against the level's terrain, sprite sheet UVs, PNG decoding of the
+* shipped assets and shader compilation under a hidden GL context. Every benchmark is calibrated
+* to a minimum sample time, sampled repeatedly, and reported with its spread, so two runs (or two
+* releases) can be compared on more than a single average.
+*
+* Build (from this directory, Linux with SDL2 and GL development packages):
+*   c++ -std=c++20 -O2 -pthread -DMEMORY_TRACKING_ENABLED=0 -I../lunarLander $(sdl2-config --cflags) benchmarks.cpp \
+*       ../lunarLander/Entity.cpp ../lunarLander/ShaderProgram.cpp ../lunarLander/LevelArena.cpp \
+*       ../lunarLander/CollisionMask.cpp ../lunarLander/Logger.cpp ../lunarLander/Profiler.cpp \
+*       ../lunarLander/SpatialQuery.cpp ../lunarLander/Terrain.cpp ../lunarLander/JobSystem.cpp ../lunarLander/MemoryTracker.cpp \
+*       $(sdl2-config --libs) -lGL -o benchmarks
+*
+* Usage:
+*   benchmarks [--filter text] [--samples n] [--min-time ms] [--assets dir] [--json file]
+*
+* JSON output: { "context": {...}, "benchmarks": [ { "name", "parameters", "iterations",
+* "samples", "min", "median", "mean", "stddev", "mad", "p90", "max", "ci95" }, ... ] } with every
+* time in nanoseconds per operation.
+*/
+
+#define STB_IMAGE_IMPLEMENTATION
+#define GL_SILENCE_DEPRECATION
+#define GL_GLEXT_PROTOTYPES 1
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+#include "stb_image.h"
+#include "Entity.h"
+#include "ContactEvent.h"
+#include "CollisionMask.h"
+#include "ShaderProgram.h"
+#include "Logger.h"
+#include "Level.h"
+#include "SpatialQuery.h"
+#include "Terrain.h"
+#include "JobSystem.h"
+
+// ––––– STRUCTS AND ENUMS ––––– //
+struct BenchmarkResult {
+    std::string m_name, m_parameters;
+    long long m_iterations;             // operations per sample
+    std::vector<double> m_samples;      // nanoseconds per operation
+
+    double m_min, m_median, m_mean, m_stddev, m_mad, m_p90, m_max, m_ci95;
+};
+
+// ––––– CONSTANTS ––––– //
+constexpr const char* ASSET_NAMES[] = { "bg.png", "ash.png", "pc.png", "shroom.png", "win.png", "lose.png", "nofuel.png" };
+constexpr int BODY_COUNTS[] = { 1, 16, 256 };
+constexpr int COLLIDER_COUNTS[] = { 3, 32, 256 };
+constexpr float ARENA_HALF_WIDTH = 8.0f;
+constexpr int RAY_BATCH_SIZE = 4096;            // "thousands of queries per tick"
+constexpr int MAX_OVERLAP_RESULTS = 64;
+
+// ––––– GLOBAL VARIABLES ––––– //
+std::string g_filter;
+int g_sample_count = 30;
+double g_min_sample_seconds = 0.005;
+std::string g_assets = "../lunarLander";
+std::string g_json_path;
+
+std::vector<BenchmarkResult> g_results;
+
+// ––––– GENERAL FUNCTIONS ––––– //
+// Keeps the optimiser from throwing away work whose result nobody reads
+template <class T>
+void keep(const T& value) { asm volatile("" : : "r,m"(value) : "memory"); }
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    double position = fraction * (sorted.size() - 1);
+    size_t below = (size_t)position;
+    size_t above = std::min(below + 1, sorted.size() - 1);
+    return sorted[below] + (sorted[above] - sorted[below]) * (position - below);
+}
+
+void summarise(BenchmarkResult& result) {
+    std::vector<double> sorted = result.m_samples;
+    std::sort(sorted.begin(), sorted.end());
+    size_t count = sorted.size();
+
+    double sum = 0.0;
+    for (double sample : sorted) sum += sample;
+    result.m_mean = sum / count;
+
+    double squares = 0.0;
+    for (double sample : sorted) squares += (sample - result.m_mean) * (sample - result.m_mean);
+    result.m_stddev = count > 1 ? sqrt(squares / (count - 1)) : 0.0;
+
+    result.m_min = sorted.front();
+    result.m_max = sorted.back();
+    result.m_median = percentile(sorted, 0.5);
+    result.m_p90 = percentile(sorted, 0.9);
+
+    // Median absolute deviation: a spread that one descheduled sample cannot blow up
+    std::vector<double> deviations;
+    for (double sample : sorted) deviations.push_back(fabs(sample - result.m_median));
+    std::sort(deviations.begin(), deviations.end());
+    result.m_mad = percentile(deviations, 0.5);
+
+    result.m_ci95 = count > 1 ? 1.96 * result.m_stddev / sqrt((double)count) : 0.0;
+}
+
+bool is_selected(const std::string& name) {
+    return g_filter.empty() || name.find(g_filter) != std::string::npos;
+}
+
+// body(iterations) performs `iterations` operations. The count doubles until one call lasts
+// g_min_sample_seconds, then g_sample_count calls of that size are timed.
+template <class Body>
+void run(const std::string& name, const std::string& parameters, Body body) {
+    if (!is_selected(name)) { return; }
+
+    using Clock = std::chrono::steady_clock;
+    auto time = [&](long long iterations) {
+        Clock::time_point start = Clock::now();
+        body(iterations);
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    long long iterations = 1;
+    while (time(iterations) < g_min_sample_seconds && iterations < (1LL << 40)) iterations *= 2;
+
+    BenchmarkResult result;
+    result.m_name = name;
+    result.m_parameters = parameters;
+    result.m_iterations = iterations;
+    for (int sample = 0; sample < g_sample_count; sample++) result.m_samples.push_back(time(iterations) * 1e9 / iterations);
+
+    summarise(result);
+    printf("%-28s %-22s %12.1f %12.1f %10.1f %9.1f%% %12lld\n", name.c_str(), parameters.c_str(), result.m_median,
+           result.m_mean, result.m_mad, result.m_mean > 0.0 ? 100.0 * result.m_stddev / result.m_mean : 0.0, iterations);
+    fflush(stdout);
+
+    g_results.push_back(result);
+}
+
+std::string format(const char* pattern, int a, int b = 0) {
+    char text[64];
+    snprintf(text, sizeof(text), pattern, a, b);
+    return text;
+}
+
+bool read_file(const std::string& path, std::vector<unsigned char>& contents) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) { return false; }
+
+    fseek(file, 0, SEEK_END);
+    contents.resize((size_t)ftell(file));
+    fseek(file, 0, SEEK_SET);
+    bool ok = fread(contents.data(), 1, contents.size(), file) == contents.size();
+    fclose(file);
+    return ok;
+}
+
+// ––––– SCENES ––––– //
+// Platforms in rows across the arena, like the level's but as many as asked for
+void place_colliders(Entity* colliders, int count, std::mt19937& random) {
+    std::uniform_real_distribution<float> x(-ARENA_HALF_WIDTH, ARENA_HALF_WIDTH), y(-3.0f, 2.0f);
+    for (int i = 0; i < count; i++) {
+        colliders[i].set_position(glm::vec3(x(random), y(random), 0.0f));
+        colliders[i].set_width(1.0f);
+        colliders[i].set_height(0.5f);
+        colliders[i].set_entity_type(SHROOM);
+    }
+}
+
+void place_bodies(Entity* bodies, int count, std::mt19937& random) {
+    std::uniform_real_distribution<float> x(-ARENA_HALF_WIDTH, ARENA_HALF_WIDTH), y(-2.0f, 3.0f), velocity(-2.0f, 2.0f);
+    for (int i = 0; i < count; i++) {
+        bodies[i].set_position(glm::vec3(x(random), y(random), 0.0f));
+        bodies[i].set_velocity(glm::vec3(velocity(random), velocity(random), 0.0f));
+        bodies[i].set_acceleration(glm::vec3(0.0f, PLAYER_GRAVITY, 0.0f));
+        bodies[i].set_speed(PLAYER_SPEED);
+        bodies[i].set_fuel(PLAYER_FUEL);
+        bodies[i].set_width(PLAYER_WIDTH);
+        bodies[i].set_height(PLAYER_HEIGHT);
+        bodies[i].set_entity_type(PLAYER);
+    }
+}
+
+// ––––– BENCHMARKS ––––– //
+void benchmark_entity_update() {
+    for (int body_count : BODY_COUNTS) {
+        for (int collider_count : COLLIDER_COUNTS) {
+            std::mt19937 random(1);
+            Entity* bodies = new Entity[body_count];
+            Entity* colliders = new Entity[collider_count];
+            place_colliders(colliders, collider_count, random);
+            ContactBuffer contacts;
+
+            // One operation is one body's update; the scene is re-placed before every sample so
+            // bodies are still moving through the colliders rather than resting on the floor
+            run("entity_update", format("bodies=%d colliders=%d", body_count, collider_count), [&](long long iterations) {
+                std::mt19937 placement(2);
+                place_bodies(bodies, body_count, placement);
+
+                long long done = 0;
+                while (done < iterations) {
+                    for (int i = 0; i < body_count && done < iterations; i++, done++) {
+                        bodies[i].update(FIXED_TIMESTEP, colliders, collider_count, contacts);
+                    }
+                    contacts.clear();
+                }
+                keep(bodies[0].get_position());
+            });
+
+            delete[] bodies;
+            delete[] colliders;
+        }
+    }
+}
+
+void benchmark_collision() {
+    std::mt19937 random(3);
+    constexpr int PAIR_COUNT = 1024;
+
+    // Half the pairs overlap, half do not, so the branch predictor cannot learn the answer
+    Entity* first = new Entity[PAIR_COUNT];
+    Entity* second = new Entity[PAIR_COUNT];
+    std::uniform_real_distribution<float> offset(-1.5f, 1.5f);
+    for (int i = 0; i < PAIR_COUNT; i++) {
+        first[i].set_position(glm::vec3(0.0f));
+        second[i].set_position(glm::vec3(offset(random), offset(random), 0.0f));
+    }
+
+    run("check_collision", "aabb", [&](long long iterations) {
+        int hits = 0;
+        for (long long i = 0; i < iterations; i++) hits += first[i % PAIR_COUNT].check_collision(&second[i % PAIR_COUNT]);
+        keep(hits);
+    });
+
+    run("sweep", "aabb", [&](long long iterations) {
+        float total = 0.0f;
+        glm::vec3 normal;
+        float penetration;
+        for (long long i = 0; i < iterations; i++) {
+            total += first[i % PAIR_COUNT].sweep(&second[i % PAIR_COUNT], glm::vec3(0.5f, -0.5f, 0.0f), normal, penetration);
+        }
+        keep(total);
+    });
+
+    // The narrowphase pass a body runs every substep, falling onto a collider and starting inside one
+    for (int collider_count : COLLIDER_COUNTS) {
+        Entity* colliders = new Entity[collider_count];
+        place_colliders(colliders, collider_count, random);
+        Entity body;
+        body.set_width(PLAYER_WIDTH);
+        body.set_height(PLAYER_HEIGHT);
+        body.set_velocity(glm::vec3(0.0f));
+        ContactBuffer contacts;
+
+        run("sweep_and_slide", format("colliders=%d", collider_count), [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                const Entity& target = colliders[i % collider_count];
+                body.set_position(target.get_position() + glm::vec3(0.0f, 1.0f, 0.0f));
+                body.set_velocity(glm::vec3(0.0f, -3.0f, 0.0f));
+                body.sweep_and_slide(glm::vec3(0.1f, -0.8f, 0.0f), colliders, collider_count, contacts);
+                if (contacts.get_count() > 512) contacts.clear();
+            }
+            keep(body.get_position());
+        });
+
+        run("sweep_and_slide", format("colliders=%d overlapping", collider_count), [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                const Entity& target = colliders[i % collider_count];
+                body.set_position(target.get_position() + glm::vec3(0.3f, 0.2f, 0.0f));
+                body.set_velocity(glm::vec3(0.0f, -3.0f, 0.0f));
+                body.sweep_and_slide(glm::vec3(0.0f, -0.05f, 0.0f), colliders, collider_count, contacts);
+                if (contacts.get_count() > 512) contacts.clear();
+            }
+            keep(body.get_position());
+        });
+
+        delete[] colliders;
+    }
+
+    delete[] first;
+    delete[] second;
+}
+
+// The query the game builds, over colliders in rows and the level's own terrain stretched to the
+// arena. One operation is one query.
+void benchmark_spatial_query() {
+    Terrain terrain;
+    terrain.generate(-ARENA_HALF_WIDTH, ARENA_HALF_WIDTH, TERRAIN_COLUMNS, TERRAIN_BASE, TERRAIN_ROUGHNESS, TERRAIN_FLOOR, nullptr, 0);
+
+    for (int collider_count : COLLIDER_COUNTS) {
+        std::mt19937 random(4);
+        Entity* colliders = new Entity[collider_count];
+        place_colliders(colliders, collider_count, random);
+
+        SpatialQuery query;
+        query.build(colliders, collider_count, &terrain);
+
+        std::uniform_real_distribution<float> x(-ARENA_HALF_WIDTH, ARENA_HALF_WIDTH), y(-2.0f, 3.0f), angle(0.0f, 6.2831853f);
+        std::vector<Ray> rays(RAY_BATCH_SIZE);
+        std::vector<RayHit> hits(RAY_BATCH_SIZE);
+        std::vector<glm::vec3> points(RAY_BATCH_SIZE);
+        for (int i = 0; i < RAY_BATCH_SIZE; i++) {
+            points[i] = glm::vec3(x(random), y(random), 0.0f);
+            float direction = angle(random);
+            rays[i] = Ray { points[i], glm::vec3(cosf(direction), sinf(direction), 0.0f), 4.0f };
+        }
+
+        std::string parameters = format("colliders=%d", collider_count);
+
+        run("raycast_batch", parameters, [&](long long iterations) {
+            for (long long done = 0; done < iterations; done += RAY_BATCH_SIZE) {
+                int count = (int)std::min<long long>(RAY_BATCH_SIZE, iterations - done);
+                query.raycast_batch(rays.data(), hits.data(), count);
+            }
+            keep(hits[0]);
+        });
+
+        run("altitude", parameters, [&](long long iterations) {
+            float total = 0.0f;
+            for (long long i = 0; i < iterations; i++) total += query.altitude(points[i % RAY_BATCH_SIZE]);
+            keep(total);
+        });
+
+        run("overlap_box", parameters, [&](long long iterations) {
+            const Entity* results[MAX_OVERLAP_RESULTS];
+            int total = 0;
+            for (long long i = 0; i < iterations; i++) {
+                total += query.overlap_box(points[i % RAY_BATCH_SIZE], glm::vec3(PLAYER_WIDTH, PLAYER_HEIGHT, 0.0f) / 2.0f, results, MAX_OVERLAP_RESULTS);
+            }
+            keep(total);
+        });
+
+        run("overlap_circle", parameters, [&](long long iterations) {
+            const Entity* results[MAX_OVERLAP_RESULTS];
+            int total = 0;
+            for (long long i = 0; i < iterations; i++) total += query.overlap_circle(points[i % RAY_BATCH_SIZE], 1.0f, results, MAX_OVERLAP_RESULTS);
+            keep(total);
+        });
+
+        run("nearest", parameters, [&](long long iterations) {
+            float total = 0.0f, distance;
+            for (long long i = 0; i < iterations; i++) {
+                query.nearest(points[i % RAY_BATCH_SIZE], glm::vec3(PLAYER_WIDTH, PLAYER_HEIGHT, 0.0f) / 2.0f, 2.0f, &distance);
+                total += distance;
+            }
+            keep(total);
+        });
+
+        delete[] colliders;
+    }
+}
+
+void benchmark_atlas() {
+    Entity sprite;
+    sprite.set_animation_cols(4);
+    sprite.set_animation_rows(4);
+
+    run("atlas_tex_coords", "4x4", [&](long long iterations) {
+        float tex_coords[12];
+        for (long long i = 0; i < iterations; i++) {
+            sprite.atlas_tex_coords((int)(i & 15), tex_coords);
+            keep(tex_coords);
+        }
+    });
+}
+
+// Decoding only: the files are read into memory first so the disk stays out of the numbers
+void benchmark_png_decode() {
+    for (const char* asset : ASSET_NAMES) {
+        std::vector<unsigned char> contents;
+        if (!read_file(g_assets + "/" + asset, contents)) {
+            fprintf(stderr, "Skipping %s: not found under %s (see --assets).\n", asset, g_assets.c_str());
+            continue;
+        }
+
+        run("png_decode", asset, [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                int width, height, components;
+                unsigned char* image = stbi_load_from_memory(contents.data(), (int)contents.size(), &width, &height, &components, STBI_rgb_alpha);
+                keep(image);
+                stbi_image_free(image);
+            }
+        });
+
+        // What load_texture adds on top for sprites with precise collision
+        int width, height, components;
+        unsigned char* image = stbi_load_from_memory(contents.data(), (int)contents.size(), &width, &height, &components, STBI_rgb_alpha);
+        if (image == nullptr) continue;
+
+        run("collision_mask_build", asset, [&](long long iterations) {
+            CollisionMask mask;
+            for (long long i = 0; i < iterations; i++) {
+                mask.build(image, width, height);
+                keep(mask);
+            }
+        });
+        stbi_image_free(image);
+    }
+}
+
+// Needs a display (or a virtual one such as Xvfb); skipped otherwise
+void benchmark_shader_load() {
+    if (!is_selected("shader_load")) { return; }
+
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        fprintf(stderr, "Skipping shader_load: %s\n", SDL_GetError());
+        return;
+    }
+
+    SDL_Window* window = SDL_CreateWindow("benchmarks", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 64, 64,
+                                          SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext context = window != nullptr ? SDL_GL_CreateContext(window) : nullptr;
+
+    if (context == nullptr) {
+        fprintf(stderr, "Skipping shader_load: %s\n", SDL_GetError());
+    } else {
+        SDL_GL_MakeCurrent(window, context);
+
+        std::string vertex_textured = g_assets + "/shaders/vertex_textured.glsl",
+                    fragment_textured = g_assets + "/shaders/fragment_textured.glsl",
+                    vertex = g_assets + "/shaders/vertex.glsl",
+                    fragment = g_assets + "/shaders/fragment.glsl";
+
+        auto load = [](const std::string& vertex_path, const std::string& fragment_path) {
+            return [vertex_path, fragment_path](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    ShaderProgram program;
+                    program.load(vertex_path.c_str(), fragment_path.c_str());
+                    glFinish();
+                    glDeleteProgram(program.get_program_id());
+                }
+            };
+        };
+
+        run("shader_load", "textured", load(vertex_textured, fragment_textured));
+        run("shader_load", "untextured", load(vertex, fragment));
+
+        SDL_GL_DeleteContext(context);
+    }
+
+    if (window != nullptr) SDL_DestroyWindow(window);
+    SDL_Quit();
+}
+
+// ––––– OUTPUT ––––– //
+bool write_json(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) { return false; }
+
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+
+    fprintf(file, "{\n  \"context\": { \"date\": \"%s\", \"compiler\": \"%s\", \"build\": \"%s\", \"samples\": %d, \"min_sample_ms\": %g },\n",
+            date, __VERSION__, build, g_sample_count, g_min_sample_seconds * 1000.0);
+    fprintf(file, "  \"benchmarks\": [\n");
+
+    for (size_t i = 0; i < g_results.size(); i++) {
+        const BenchmarkResult& result = g_results[i];
+        fprintf(file, "    { \"name\": \"%s\", \"parameters\": \"%s\", \"unit\": \"ns\", \"iterations\": %lld, \"samples\": %d, "
+                      "\"min\": %.3f, \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, \"mad\": %.3f, \"p90\": %.3f, "
+                      "\"max\": %.3f, \"ci95\": %.3f }%s\n",
+                result.m_name.c_str(), result.m_parameters.c_str(), result.m_iterations, (int)result.m_samples.size(),
+                result.m_min, result.m_median, result.m_mean, result.m_stddev, result.m_mad, result.m_p90, result.m_max,
+                result.m_ci95, i + 1 < g_results.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+bool parse_arguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) { return false; }
+        i++;
+
+        if      (!strcmp(option, "--filter"))    g_filter = value;
+        else if (!strcmp(option, "--samples"))   g_sample_count = atoi(value);
+        else if (!strcmp(option, "--min-time"))  g_min_sample_seconds = atof(value) / 1000.0;
+        else if (!strcmp(option, "--assets"))    g_assets = value;
+        else if (!strcmp(option, "--json"))      g_json_path = value;
+        else return false;
+    }
+    return g_sample_count > 0 && g_min_sample_seconds > 0.0;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parse_arguments(argc, argv)) {
+        fprintf(stderr, "usage: %s [--filter text] [--samples n] [--min-time ms] [--assets dir] [--json file]\n", argv[0]);
+        return 1;
+    }
+
+    // The entities log their fuel; that is not what is being measured
+    g_logger.set_severity(SEVERITY_WARNING);
+
+    printf("%-28s %-22s %12s %12s %10s %10s %12s\n", "benchmark", "parameters", "median ns", "mean ns", "mad ns", "cv", "iterations");
+
+    benchmark_entity_update();
+    benchmark_collision();
+    benchmark_spatial_query();
+    benchmark_atlas();
+    benchmark_png_decode();
+    benchmark_shader_load();
+
+    if (!g_json_path.empty()) {
+        if (write_json(g_json_path.c_str())) printf("Results written to %s\n", g_json_path.c_str());
+        else fprintf(stderr, "Unable to write %s\n", g_json_path.c_str());
+    }
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+/*
+* Landing envelope analyser
+*
+* Sweeps a grid (or random samples) of starting positions, velocities, fuel levels and thrust
+* policies through the headless BatchSimulation on every core, and writes one record per trial:
+* where it started, which policy flew it, how it ended and how long it took.
+*
+* Build (from this directory):
+*   c++ -std=c++20 -O3 -pthread -DMEMORY_TRACKING_ENABLED=0 -I../lunarLander landing_envelope.cpp \
+*       ../lunarLander/BatchSimulation.cpp ../lunarLander/JobSystem.cpp ../lunarLander/Profiler.cpp \
+*       -o landing_envelope
+*
+* Usage:
+*   landing_envelope [--x min:max:n] [--y min:max:n] [--vx min:max:n] [--vy min:max:n]
+*                    [--fuel min:max:n] [--policies drift,left,right,seek,brake]
+*                    [--random count] [--seed s] [--max-steps n] [--threads n]
+*                    [--format csv|bin] [--out file]
+*
+* Binary format: "LLEV", uint32 version, uint64 record count, then packed records of
+* five floats (x, y, vx, vy, fuel), uint8 policy, uint8 outcome, uint16 steps.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "BatchSimulation.h"
+#include "JobSystem.h"
+
+// ––––– STRUCTS AND ENUMS ––––– //
+enum Policy : uint8_t { DRIFT, THRUST_LEFT, THRUST_RIGHT, SEEK_PAD, BRAKE, POLICY_COUNT };
+
+struct Range {
+    float m_min, m_max;
+    int m_steps;
+
+    float const at(int index) const {
+        return m_steps <= 1 ? m_min : m_min + (m_max - m_min) * (float)index / (float)(m_steps - 1);
+    }
+};
+
+#pragma pack(push, 1)
+struct TrialRecord {
+    float m_x, m_y, m_velocity_x, m_velocity_y, m_fuel;
+    uint8_t m_policy;
+    uint8_t m_outcome;
+    uint16_t m_steps;
+};
+#pragma pack(pop)
+
+// ––––– CONSTANTS ––––– //
+constexpr char BINARY_MAGIC[4] = { 'L', 'L', 'E', 'V' };
+constexpr uint32_t BINARY_VERSION = 1;
+constexpr int CHUNK_SIZE = 8192;            // trials per batch simulation
+constexpr int CHUNKS_PER_WAVE = 64;         // chunks in flight before results are flushed in order
+constexpr float COMPACT_BELOW = 0.875f;     // compact a chunk once fewer of its stepped trials are still running
+
+constexpr const char* POLICY_NAMES[POLICY_COUNT] = { "drift", "left", "right", "seek", "brake" };
+constexpr const char* OUTCOME_NAMES[] = { "timeout", "win", "lose", "nofuel" };
+
+// ––––– GLOBAL VARIABLES ––––– //
+Range g_x = { -4.5f, 4.5f, 19 },
+      g_y = { -1.0f, 3.0f, 9 },
+      g_velocity_x = { -2.0f, 2.0f, 9 },
+      g_velocity_y = { -2.0f, 0.0f, 5 },
+      g_fuel = { 10.0f, PLAYER_FUEL, 4 };
+
+std::vector<Policy> g_policies = { DRIFT, THRUST_LEFT, THRUST_RIGHT, SEEK_PAD, BRAKE };
+
+long long g_random_trials = 0;
+unsigned g_seed = 1;
+int g_max_steps = 60 * 20;                  // twenty seconds of game time
+int g_threads = 0;
+bool g_binary = false;
+std::string g_output_path = "landing_envelope.csv";
+
+// ––––– GENERAL FUNCTIONS ––––– //
+bool parse_range(const char* text, Range& range) {
+    return sscanf(text, "%f:%f:%d", &range.m_min, &range.m_max, &range.m_steps) == 3 && range.m_steps > 0;
+}
+
+bool parse_policies(const char* text) {
+    g_policies.clear();
+    std::string list = text;
+    size_t start = 0;
+
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string name = list.substr(start, end - start);
+
+        bool found = false;
+        for (int p = 0; p < POLICY_COUNT; p++) {
+            if (name == POLICY_NAMES[p]) { g_policies.push_back((Policy)p); found = true; }
+        }
+        if (!found) { return false; }
+
+        start = end + 1;
+    }
+    return !g_policies.empty();
+}
+
+bool parse_arguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) { return false; }
+        i++;
+
+        bool ok = true;
+        if      (!strcmp(option, "--x"))         ok = parse_range(value, g_x);
+        else if (!strcmp(option, "--y"))         ok = parse_range(value, g_y);
+        else if (!strcmp(option, "--vx"))        ok = parse_range(value, g_velocity_x);
+        else if (!strcmp(option, "--vy"))        ok = parse_range(value, g_velocity_y);
+        else if (!strcmp(option, "--fuel"))      ok = parse_range(value, g_fuel);
+        else if (!strcmp(option, "--policies"))  ok = parse_policies(value);
+        else if (!strcmp(option, "--random"))    g_random_trials = atoll(value);
+        else if (!strcmp(option, "--seed"))      g_seed = (unsigned)atoi(value);
+        else if (!strcmp(option, "--max-steps")) g_max_steps = atoi(value);
+        else if (!strcmp(option, "--threads"))   g_threads = atoi(value);
+        else if (!strcmp(option, "--format"))    g_binary = !strcmp(value, "bin");
+        else if (!strcmp(option, "--out"))       g_output_path = value;
+        else ok = false;
+
+        if (!ok) { return false; }
+    }
+    return true;
+}
+
+long long trial_count() {
+    if (g_random_trials > 0) { return g_random_trials; }
+    return (long long)g_x.m_steps * g_y.m_steps * g_velocity_x.m_steps * g_velocity_y.m_steps
+         * g_fuel.m_steps * (long long)g_policies.size();
+}
+
+// Grid trials are a mixed-radix decomposition of the index; random ones are seeded per trial
+// so the result does not depend on how chunks were scheduled.
+void describe_trial(long long index, TrialRecord& trial) {
+    if (g_random_trials > 0) {
+        std::mt19937 rng(g_seed ^ (unsigned)(index * 2654435761u));
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        trial.m_x          = g_x.m_min + (g_x.m_max - g_x.m_min) * unit(rng);
+        trial.m_y          = g_y.m_min + (g_y.m_max - g_y.m_min) * unit(rng);
+        trial.m_velocity_x = g_velocity_x.m_min + (g_velocity_x.m_max - g_velocity_x.m_min) * unit(rng);
+        trial.m_velocity_y = g_velocity_y.m_min + (g_velocity_y.m_max - g_velocity_y.m_min) * unit(rng);
+        trial.m_fuel       = g_fuel.m_min + (g_fuel.m_max - g_fuel.m_min) * unit(rng);
+        trial.m_policy     = g_policies[rng() % g_policies.size()];
+        return;
+    }
+
+    trial.m_policy = g_policies[index % g_policies.size()];   index /= g_policies.size();
+    trial.m_fuel = g_fuel.at(index % g_fuel.m_steps);              index /= g_fuel.m_steps;
+    trial.m_velocity_y = g_velocity_y.at(index % g_velocity_y.m_steps); index /= g_velocity_y.m_steps;
+    trial.m_velocity_x = g_velocity_x.at(index % g_velocity_x.m_steps); index /= g_velocity_x.m_steps;
+    trial.m_y = g_y.at(index % g_y.m_steps);                       index /= g_y.m_steps;
+    trial.m_x = g_x.at(index % g_x.m_steps);
+}
+
+uint8_t choose_action(Policy policy, const float* observation) {
+    float x = observation[0],
+          velocity_x = observation[2];
+
+    switch (policy) {
+        case THRUST_LEFT:
+            return ACTION_LEFT;
+
+        case THRUST_RIGHT:
+            return ACTION_RIGHT;
+
+        case SEEK_PAD: {
+            // Head for the nearest pc, easing off as we get close
+            float target = x;
+            float best_distance = INFINITY;
+            for (int p = 0; p < PLATFORM_COUNT; p++) {
+                if (LEVEL_PLATFORMS[p].m_type != PC) continue;
+                float distance = fabsf(LEVEL_PLATFORMS[p].m_x - x);
+                if (distance < best_distance) { best_distance = distance; target = LEVEL_PLATFORMS[p].m_x; }
+            }
+            float desired_velocity = (target - x) * 0.5f;
+            if (velocity_x < desired_velocity - 0.1f) return ACTION_RIGHT;
+            if (velocity_x > desired_velocity + 0.1f) return ACTION_LEFT;
+            return ACTION_NONE;
+        }
+
+        case BRAKE:
+            if (velocity_x > 0.1f) return ACTION_LEFT;
+            if (velocity_x < -0.1f) return ACTION_RIGHT;
+            return ACTION_NONE;
+
+        default:
+            return ACTION_NONE;
+    }
+}
+
+// Flies one chunk of trials to completion in its own batch simulation
+void run_chunk(long long first_trial, int count, TrialRecord* records) {
+    BatchSimulation simulation(count);
+
+    for (int i = 0; i < count; i++) {
+        describe_trial(first_trial + i, records[i]);
+        const TrialRecord& trial = records[i];
+        simulation.reset_episode(i, trial.m_x, trial.m_y, trial.m_velocity_x, trial.m_velocity_y, trial.m_fuel);
+    }
+
+    std::vector<uint8_t> actions(count), dones(count);
+    std::vector<float> observations(count * BatchSimulation::OBSERVATION_SIZE), rewards(count);
+    simulation.observe(observations.data());
+
+    // Trials end at very different times (running out of fuel takes a second, a timeout takes
+    // g_max_steps), so finished ones are compacted away instead of being stepped along
+    std::vector<int> trials(count);
+    for (int i = 0; i < count; i++) trials[i] = i;
+    int active = count;
+
+    for (int step = 0; step < g_max_steps && active > 0; step++) {
+        for (int i = 0; i < active; i++) {
+            actions[i] = choose_action((Policy)records[trials[i]].m_policy, &observations[i * BatchSimulation::OBSERVATION_SIZE]);
+        }
+
+        simulation.step(actions.data(), observations.data(), rewards.data(), dones.data());
+
+        int running = 0;
+        for (int i = 0; i < active; i++) running += dones[i] ? 0 : 1;
+
+        if (running < active * COMPACT_BELOW) {
+            active = simulation.compact(trials.data());
+            simulation.observe(observations.data());
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        TrialRecord& record = records[trials[i]];
+        record.m_outcome = simulation.get_outcome(i);
+        int steps = simulation.get_steps(i);
+        record.m_steps = (uint16_t)(steps > UINT16_MAX ? UINT16_MAX : steps);
+    }
+}
+
+void write_records(FILE* file, const TrialRecord* records, int count) {
+    if (g_binary) {
+        fwrite(records, sizeof(TrialRecord), count, file);
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const TrialRecord& trial = records[i];
+        fprintf(file, "%g,%g,%g,%g,%g,%s,%s,%d,%.4f\n",
+                trial.m_x, trial.m_y, trial.m_velocity_x, trial.m_velocity_y, trial.m_fuel,
+                POLICY_NAMES[trial.m_policy], OUTCOME_NAMES[trial.m_outcome],
+                trial.m_steps, trial.m_steps * FIXED_TIMESTEP);
+    }
+}
+
+// ––––– MAIN ––––– //
+int main(int argc, char* argv[]) {
+    if (!parse_arguments(argc, argv)) {
+        fprintf(stderr, "usage: %s [--x min:max:n] [--y min:max:n] [--vx min:max:n] [--vy min:max:n] "
+                        "[--fuel min:max:n] [--policies drift,left,right,seek,brake] [--random count] "
+                        "[--seed s] [--max-steps n] [--threads n] [--format csv|bin] [--out file]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* file = fopen(g_output_path.c_str(), g_binary ? "wb" : "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Unable to open %s for writing.\n", g_output_path.c_str());
+        return 1;
+    }
+
+    long long total = trial_count();
+
+    if (g_binary) {
+        uint64_t record_count = (uint64_t)total;
+        fwrite(BINARY_MAGIC, 1, sizeof(BINARY_MAGIC), file);
+        fwrite(&BINARY_VERSION, sizeof(BINARY_VERSION), 1, file);
+        fwrite(&record_count, sizeof(record_count), 1, file);
+    } else {
+        fprintf(file, "x,y,vx,vy,fuel,policy,outcome,steps,seconds\n");
+    }
+
+    JobSystem job_system;
+    job_system.initialise(g_threads > 0 ? g_threads - 1 : 0);
+
+    std::vector<TrialRecord> records((size_t)CHUNK_SIZE * CHUNKS_PER_WAVE);
+    long long outcome_counts[4] = { 0, 0, 0, 0 };
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Chunks of a wave run in parallel; waves are written in order so the output is deterministic
+    for (long long wave_start = 0; wave_start < total; wave_start += (long long)CHUNK_SIZE * CHUNKS_PER_WAVE) {
+        long long wave_trials = total - wave_start;
+        if (wave_trials > (long long)records.size()) wave_trials = (long long)records.size();
+        int chunk_count = (int)((wave_trials + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+        job_system.parallel_for(chunk_count, 1, [&](int begin, int end) {
+            for (int chunk = begin; chunk < end; chunk++) {
+                long long first = (long long)chunk * CHUNK_SIZE;
+                int count = (int)(wave_trials - first < CHUNK_SIZE ? wave_trials - first : CHUNK_SIZE);
+                run_chunk(wave_start + first, count, &records[first]);
+            }
+        });
+
+        for (long long i = 0; i < wave_trials; i++) outcome_counts[records[i].m_outcome]++;
+        write_records(file, records.data(), (int)wave_trials);
+    }
+
+    fclose(file);
+    int thread_count = job_system.get_thread_count();      // shutdown() leaves only this thread
+    job_system.shutdown();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%lld trials in %.2f s (%.0f trials/s) on %d thread(s) -> %s\n",
+           total, seconds, total / (seconds > 0.0 ? seconds : 1.0), thread_count, g_output_path.c_str());
+    for (int outcome = 0; outcome < 4; outcome++) {
+        printf("  %-8s %lld\n", OUTCOME_NAMES[outcome], outcome_counts[outcome]);
+    }
+
+    return 0;
+}
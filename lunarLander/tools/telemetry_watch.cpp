@@ -0,0 +1,109 @@
+/*
+* Telemetry watcher
+*
+* Prints the live telemetry of running games, one line per instance per interval. With no names
+* it picks up every /lunar_lander.<pid> segment it can find (Linux lists them under /dev/shm;
+* elsewhere pass the names the games logged at startup). Segments left behind by games that
+* crashed are skipped and removed.
+*
+* Build (from this directory):
+*   c++ -std=c++20 -O2 -I../lunarLander telemetry_watch.cpp ../lunarLander/Telemetry.cpp \
+*       -o telemetry_watch
+*   (add -lrt on older glibc)
+*
+* Usage:
+*   telemetry_watch [--interval ms] [--count n] [name ...]
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include "Telemetry.h"
+
+// ––––– CONSTANTS ––––– //
+constexpr char SHARED_MEMORY_DIRECTORY[] = "/dev/shm";
+constexpr char SEGMENT_PREFIX[] = "lunar_lander.";
+
+// ––––– GLOBAL VARIABLES ––––– //
+int g_interval_ms = 500;
+int g_count = 0;                            // 0 keeps going until interrupted
+std::vector<std::string> g_names;
+
+// ––––– GENERAL FUNCTIONS ––––– //
+void find_segments() {
+    DIR* directory = opendir(SHARED_MEMORY_DIRECTORY);
+    if (directory == nullptr) { return; }
+
+    while (dirent* entry = readdir(directory)) {
+        if (strncmp(entry->d_name, SEGMENT_PREFIX, strlen(SEGMENT_PREFIX)) == 0) g_names.push_back(std::string("/") + entry->d_name);
+    }
+    closedir(directory);
+}
+
+bool parse_arguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--interval") && i + 1 < argc) g_interval_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--count") && i + 1 < argc) g_count = atoi(argv[++i]);
+        else if (argv[i][0] == '-') return false;
+        else g_names.push_back(argv[i]);
+    }
+    return g_interval_ms > 0;
+}
+
+const char* outcome_name(uint32_t outcome) {
+    if (outcome & OUTCOME_WIN) return "win";
+    if (outcome & OUTCOME_LOSE) return "lose";
+    if (outcome & OUTCOME_NO_FUEL) return "nofuel";
+    return "playing";
+}
+
+int main(int argc, char* argv[]) {
+    if (!parse_arguments(argc, argv)) {
+        fprintf(stderr, "usage: %s [--interval ms] [--count n] [name ...]\n", argv[0]);
+        return 1;
+    }
+
+    // Found segments that fail to open are stale or from another version; only named ones are errors
+    bool found = g_names.empty();
+    if (found) find_segments();
+
+    std::vector<std::unique_ptr<TelemetryReader>> readers;
+    for (const std::string& name : g_names) {
+        std::unique_ptr<TelemetryReader> reader(new TelemetryReader());
+        if (reader->open(name.c_str())) readers.push_back(std::move(reader));
+        else if (!found) fprintf(stderr, "Unable to open %s (not running, or a different telemetry version).\n", name.c_str());
+    }
+    if (readers.empty()) {
+        if (found) fprintf(stderr, "No running instances found.\n");
+        return 1;
+    }
+
+    printf("%8s %8s %8s %9s %9s %5s %6s %5s %7s %7s %6s %9s %9s %8s %6s %8s\n",
+           "pid", "frame", "tick", "frame_ms", "step_us", "steps", "pairs", "draws", "fuel", "alt", "awake", "arena_kb",
+           "heap_kb", "gpu_kb", "allocs", "state");
+
+    for (int round = 0; g_count == 0 || round < g_count; round++) {
+        for (const std::unique_ptr<TelemetryReader>& reader : readers) {
+            TelemetrySample sample;
+            if (!reader->read(sample)) continue;
+
+            printf("%8d %8llu %8llu %9.3f %9.2f %5u %6u %5u %7.1f %7.2f %3u/%-2u %9.1f %9.1f %8.0f %6u %8s\n", reader->get_pid(),
+                   (unsigned long long)sample.m_frame, (unsigned long long)sample.m_tick,
+                   sample.m_frame_nanoseconds / 1e6, sample.m_step_nanoseconds / 1e3, sample.m_steps, sample.m_pairs_tested,
+                   sample.m_draw_calls, sample.m_fuel, sample.m_altitude, sample.m_awake_count, sample.m_body_count,
+                   sample.m_arena_bytes / 1024.0, sample.m_heap_bytes / 1024.0, sample.m_gpu_bytes / 1024.0,
+                   sample.m_frame_allocations, outcome_name(sample.m_outcome));
+        }
+        fflush(stdout);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(g_interval_ms));
+    }
+
+    return 0;
+}